@@ -0,0 +1,766 @@
+// deps
+#include <assimp/scene.h>
+#include <fmt/core.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <glm/gtc/matrix_transform.hpp>
+// global
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+// local
+#include "app/parallel.h"
+#include "app/task_system.h"
+#include "assets/animation.h"
+#include "assets/block_compression.h"
+#include "assets/vertex_cache.h"
+#include "assets/vertex_data.h"
+#include "files.h"
+#include "math/intersection.h"
+#include "mi_types.h"
+#include "opengl/shader.h"
+#include "scene/instance_batch.h"
+
+// CPU hot paths of the engine with synthetic data (fixed seed)
+// headless, no window and no OpenGL context, runs on Linux too
+// CSV to stdout, one row per benchmark, logs go to stderr
+// exit code 1 if the BCn encoder is below its PSNR, the optimized
+// triangle order of the grid is above its ACMR or the compact vertices
+// and skin are above their error
+// usage: HotPathsBench [name filter], run from the build directory
+// (shaders are read from "../shaders" like the engine does)
+
+namespace {
+
+using namespace std::chrono;
+using fns = duration<double, std::nano>;
+
+constexpr int kWorkers = 4;
+// every sample repeats the benchmark for at least kSampleTime
+constexpr int kSamples = 15;
+constexpr auto kSampleTime = milliseconds(20);
+
+// results are written here, the compiler can't drop the loops
+volatile uint64_t gSink = 0;
+
+struct Benchmark {
+  const char* name;
+  // work items per call, e.g. boxes tested or vertices extracted
+  size_t items;
+  std::function<void()> fn;
+};
+
+void Run(const Benchmark& bench) {
+  // warm-up: caches, allocations, parked workers
+  bench.fn();
+
+  MiVector<double> ns_per_item;
+  ns_per_item.reserve(kSamples);
+  size_t total_calls = 0;
+  for (int sample = 0; sample < kSamples; ++sample) {
+    size_t calls = 0;
+    auto start = steady_clock::now();
+    auto elapsed = steady_clock::duration::zero();
+    do {
+      bench.fn();
+      ++calls;
+      elapsed = steady_clock::now() - start;
+    } while (elapsed < kSampleTime);
+    total_calls += calls;
+    ns_per_item.push_back(duration_cast<fns>(elapsed).count() /
+                          static_cast<double>(calls * bench.items));
+  }
+
+  std::sort(ns_per_item.begin(), ns_per_item.end());
+  fmt::print("{},{},{},{:.3f},{:.3f}\n", bench.name, bench.items, total_calls,
+             ns_per_item[ns_per_item.size() / 2], ns_per_item.front());
+}
+
+glm::vec3 RandomVec3(std::mt19937& prng, float min, float max) {
+  std::uniform_real_distribution<float> dist(min, max);
+  return glm::vec3(dist(prng), dist(prng), dist(prng));
+}
+
+// math::
+
+struct CullingData {
+  Frustum frustum;
+  MiVector<AABB> boxes;
+  MiVector<Sphere> spheres;
+  MiVector<Ray> rays;
+};
+
+CullingData CreateCullingData(size_t count) {
+  std::mt19937 prng(42);
+  CullingData data;
+  glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f,
+                                    200.0f);
+  glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 50.0f), glm::vec3(0.0f),
+                               glm::vec3(0.0f, 1.0f, 0.0f));
+  data.frustum = Frustum(proj * view);
+
+  // about a half is visible
+  data.boxes.reserve(count);
+  data.spheres.reserve(count);
+  data.rays.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    glm::vec3 center = RandomVec3(prng, -100.0f, 100.0f);
+    glm::vec3 extent = RandomVec3(prng, 0.5f, 5.0f);
+    data.boxes.emplace_back(center - extent, center + extent);
+    data.spheres.emplace_back(center, glm::length(extent));
+    glm::vec3 dir = glm::normalize(RandomVec3(prng, -1.0f, 1.0f));
+    data.rays.emplace_back(glm::vec3(0.0f, 10.0f, 50.0f), dir);
+  }
+  return data;
+}
+
+// vertex extraction and animation
+
+constexpr unsigned int kGridSize = 128;
+constexpr unsigned int kBones = 64;
+constexpr unsigned int kKeys = 60;
+
+aiString BoneName(unsigned int bone) {
+  return aiString(fmt::format("Bone{}", bone));
+}
+
+// skinned grid, every vertex is weighted by two bones
+// released by the aiMesh destructor (Assimp owns the arrays)
+aiMesh* CreateMesh() {
+  constexpr unsigned int kVertices = kGridSize * kGridSize;
+  constexpr unsigned int kQuads = (kGridSize - 1) * (kGridSize - 1);
+
+  auto* mesh = new aiMesh();
+  mesh->mName = aiString(std::string("Grid"));
+  mesh->mNumVertices = kVertices;
+  mesh->mVertices = new aiVector3D[kVertices];
+  mesh->mNormals = new aiVector3D[kVertices];
+  mesh->mTangents = new aiVector3D[kVertices];
+  mesh->mBitangents = new aiVector3D[kVertices];
+  mesh->mTextureCoords[0] = new aiVector3D[kVertices];
+  mesh->mNumUVComponents[0] = 2;
+  for (unsigned int y = 0; y < kGridSize; ++y) {
+    for (unsigned int x = 0; x < kGridSize; ++x) {
+      unsigned int i = y * kGridSize + x;
+      float u = static_cast<float>(x) / (kGridSize - 1);
+      float v = static_cast<float>(y) / (kGridSize - 1);
+      mesh->mVertices[i] = aiVector3D(u, v, 0.0f);
+      mesh->mNormals[i] = aiVector3D(0.0f, 0.0f, 1.0f);
+      mesh->mTangents[i] = aiVector3D(1.0f, 0.0f, 0.0f);
+      mesh->mBitangents[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+      mesh->mTextureCoords[0][i] = aiVector3D(u, v, 0.0f);
+    }
+  }
+
+  mesh->mNumFaces = kQuads * 2;
+  mesh->mFaces = new aiFace[mesh->mNumFaces];
+  for (unsigned int y = 0, f = 0; y < kGridSize - 1; ++y) {
+    for (unsigned int x = 0; x < kGridSize - 1; ++x) {
+      unsigned int i = y * kGridSize + x;
+      unsigned int quad[2][3]{{i, i + 1, i + kGridSize},
+                              {i + 1, i + kGridSize + 1, i + kGridSize}};
+      for (const auto& triangle : quad) {
+        aiFace& face = mesh->mFaces[f++];
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3];
+        std::copy(std::begin(triangle), std::end(triangle), face.mIndices);
+      }
+    }
+  }
+
+  // rows of the grid are split between the bones, blended with the next one
+  const unsigned int rows_per_bone = kGridSize / kBones;
+  mesh->mNumBones = kBones;
+  mesh->mBones = new aiBone*[kBones];
+  for (unsigned int b = 0; b < kBones; ++b) {
+    auto* bone = new aiBone();
+    bone->mName = BoneName(b);
+    unsigned int first_row = b * rows_per_bone;
+    unsigned int last_row = std::min(first_row + rows_per_bone * 2, kGridSize);
+    bone->mNumWeights = (last_row - first_row) * kGridSize;
+    bone->mWeights = new aiVertexWeight[bone->mNumWeights];
+    for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+      bone->mWeights[w].mVertexId = first_row * kGridSize + w;
+      bone->mWeights[w].mWeight = 0.5f;
+    }
+    mesh->mBones[b] = bone;
+  }
+  return mesh;
+}
+
+// Blender's layout: RootNode -> Armature -> bones (binary tree)
+aiNode* CreateHierarchy() {
+  MiVector<aiNode*> bones(kBones);
+  for (unsigned int b = 0; b < kBones; ++b) {
+    bones[b] = new aiNode(BoneName(b).C_Str());
+  }
+  // node b is the parent of 2b + 1 and 2b + 2
+  for (unsigned int b = kBones - 1; b > 0; --b) {
+    aiNode* child = bones[b];
+    bones[(b - 1) / 2]->addChildren(1, &child);
+  }
+
+  auto* root = new aiNode("RootNode");
+  auto* armature = new aiNode("Armature");
+  armature->addChildren(1, &bones[0]);
+  root->addChildren(1, &armature);
+  return root;
+}
+
+aiAnimation* CreateAnimation() {
+  std::mt19937 prng(7);
+  std::uniform_real_distribution<float> angle(-0.5f, 0.5f);
+
+  auto* animation = new aiAnimation();
+  animation->mName = aiString(std::string("Wave"));
+  animation->mDuration = kKeys - 1;
+  animation->mTicksPerSecond = 30.0;
+  animation->mNumChannels = kBones;
+  animation->mChannels = new aiNodeAnim*[kBones];
+  for (unsigned int b = 0; b < kBones; ++b) {
+    auto* channel = new aiNodeAnim();
+    channel->mNodeName = BoneName(b);
+    channel->mNumPositionKeys = kKeys;
+    channel->mNumRotationKeys = kKeys;
+    channel->mNumScalingKeys = kKeys;
+    channel->mPositionKeys = new aiVectorKey[kKeys];
+    channel->mRotationKeys = new aiQuatKey[kKeys];
+    channel->mScalingKeys = new aiVectorKey[kKeys];
+    for (unsigned int k = 0; k < kKeys; ++k) {
+      double time = k;
+      glm::quat q{glm::vec3(angle(prng), angle(prng), angle(prng))};
+      channel->mPositionKeys[k] =
+          aiVectorKey(time, aiVector3D(0.0f, 1.0f / kBones, 0.0f));
+      channel->mRotationKeys[k] =
+          aiQuatKey(time, aiQuaternion(q.w, q.x, q.y, q.z));
+      channel->mScalingKeys[k] = aiVectorKey(time, aiVector3D(1.0f));
+    }
+    animation->mChannels[b] = channel;
+  }
+  return animation;
+}
+
+// vertex cache order: the grid's triangles shuffled like an export that
+// lost the order, Tipsify and the overdraw clusters reach ~0.65
+constexpr float kMaxOptimizedAcmr = 0.7f;
+
+vertex::Stream<unsigned int> ShuffleTriangles(const aiMesh* mesh) {
+  vertex::Stream<unsigned int> indices;
+  vertex::ExtractIndices(mesh, indices);
+  MiVector<unsigned int> order(mesh->mNumFaces);
+  std::iota(order.begin(), order.end(), 0U);
+  std::shuffle(order.begin(), order.end(), std::mt19937(3));
+  vertex::Stream<unsigned int> shuffled;
+  shuffled.reserve(indices.size());
+  for (unsigned int triangle : order) {
+    shuffled.insert(shuffled.end(), indices.begin() + triangle * 3,
+                    indices.begin() + triangle * 3 + 3);
+  }
+  return shuffled;
+}
+
+// false if the optimized order is too far from the ideal
+bool CheckVertexCache(std::span<const unsigned int> shuffled,
+                      std::span<const glm::vec3> positions) {
+  vertex::Stream<unsigned int> indices(shuffled.begin(), shuffled.end());
+  const auto source = vertex::GetCacheStats(indices, positions.size());
+  vertex::OptimizeTriangles(indices, positions);
+  const auto optimized = vertex::GetCacheStats(indices, positions.size());
+  if (optimized.acmr > kMaxOptimizedAcmr) {
+    spdlog::error("mesh_optimize_triangles: ACMR {:.3f}, expected {:.3f}",
+                  optimized.acmr, kMaxOptimizedAcmr);
+    return false;
+  }
+  spdlog::info(
+      "mesh_optimize_triangles: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+      source.acmr, optimized.acmr, source.atvr, optimized.atvr);
+  return true;
+}
+
+// compact vertices: random tangent frames of both handedness, the
+// angles of snorm16 octahedral ~0.05 degrees
+constexpr float kMaxPackedDegrees = 0.1f;
+// half floats of [0, 1], 2^-11 at most
+constexpr float kMaxPackedTexCoords = 1.0f / 1024.0f;
+
+struct TangentFrame {
+  glm::vec3 normal;
+  glm::vec3 tangent;
+  glm::vec3 bitangent;
+  glm::vec2 tex_coords;
+};
+
+MiVector<TangentFrame> CreateTangentFrames(size_t count) {
+  std::mt19937 prng(7);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  MiVector<TangentFrame> frames(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto& frame = frames[i];
+    frame.normal = glm::normalize(RandomVec3(prng, -1.0f, 1.0f));
+    const glm::vec3 side = glm::normalize(RandomVec3(prng, -1.0f, 1.0f));
+    frame.tangent = glm::normalize(glm::cross(frame.normal, side));
+    frame.bitangent = glm::cross(frame.normal, frame.tangent);
+    // mirrored UVs
+    if (i % 2) frame.bitangent = -frame.bitangent;
+    frame.tex_coords = glm::vec2(unit(prng), unit(prng));
+  }
+  return frames;
+}
+
+float AngleDegrees(const glm::vec3& a, const glm::vec3& b) {
+  return glm::degrees(std::acos(std::clamp(glm::dot(a, b), -1.0f, 1.0f)));
+}
+
+// false if a decoded frame is too far from its source
+bool CheckVertexFormat(const MiVector<TangentFrame>& frames) {
+  float max_degrees = 0.0f;
+  float max_tex_coords = 0.0f;
+  for (const auto& frame : frames) {
+    const glm::vec3 normal =
+        vertex::UnpackNormal(vertex::PackNormal(frame.normal));
+    glm::vec3 tangent;
+    glm::vec3 bitangent;
+    vertex::UnpackTangent(
+        vertex::PackTangent(frame.normal, frame.tangent, frame.bitangent),
+        normal, tangent, bitangent);
+    const glm::vec2 tex_coords = vertex::UnpackTexCoords(vertex::PackTexCoords(
+        frame.tex_coords.x, frame.tex_coords.y));
+    max_degrees = std::max({max_degrees, AngleDegrees(normal, frame.normal),
+                            AngleDegrees(tangent, frame.tangent),
+                            AngleDegrees(bitangent, frame.bitangent)});
+    max_tex_coords =
+        std::max({max_tex_coords, std::abs(tex_coords.x - frame.tex_coords.x),
+                  std::abs(tex_coords.y - frame.tex_coords.y)});
+  }
+  if (max_degrees > kMaxPackedDegrees ||
+      max_tex_coords > kMaxPackedTexCoords) {
+    spdlog::error(
+        "mesh_pack_vertices: {:.3f} degrees, {:.6f} tex coords, expected "
+        "{:.3f}, {:.6f}",
+        max_degrees, max_tex_coords, kMaxPackedDegrees, kMaxPackedTexCoords);
+    return false;
+  }
+  spdlog::info("mesh_pack_vertices: {:.3f} degrees, {:.6f} tex coords",
+               max_degrees, max_tex_coords);
+  return true;
+}
+
+// compact skin: 1 to 4 random weights like Assimp's LimitBoneWeights,
+// the largest remainders are within one unorm8 step
+constexpr float kMaxPackedWeight = 1.0f / vertex::kWeightsSum;
+
+struct SkinStreams {
+  vertex::Stream<glm::ivec4> bones;
+  vertex::Stream<glm::vec4> weights;
+};
+
+SkinStreams CreateSkin(size_t count) {
+  std::mt19937 prng(11);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::uniform_int_distribution<int> bone(0, kBones - 1);
+  SkinStreams skin;
+  skin.bones.resize(count, glm::ivec4(0));
+  skin.weights.resize(count, glm::vec4(0.0f));
+  for (size_t v = 0; v < count; ++v) {
+    const int used = static_cast<int>(v % global::kMaxBonesPerVertex) + 1;
+    float sum = 0.0f;
+    for (int i = 0; i < used; ++i) {
+      skin.bones[v][i] = bone(prng);
+      skin.weights[v][i] = unit(prng) + 0.01f;
+      sum += skin.weights[v][i];
+    }
+    skin.weights[v] /= sum;
+  }
+  return skin;
+}
+
+// false if the packed skin differs from the float path
+bool CheckSkin(const SkinStreams& skin) {
+  vertex::Stream<glm::i16vec4> bones(skin.bones.size());
+  vertex::Stream<glm::u8vec4> weights(skin.weights.size());
+  for (size_t v = 0; v < skin.bones.size(); ++v) {
+    bones[v] = vertex::PackBones(skin.bones[v]);
+    weights[v] = vertex::PackWeights(skin.weights[v]);
+  }
+  vertex::SkinErrors errors;
+  vertex::ValidateSkin(skin.bones, skin.weights, bones, weights, errors);
+  if (errors.bones || errors.sums || errors.max_weight > kMaxPackedWeight) {
+    spdlog::error(
+        "mesh_pack_skin: {} bones, {} sums, {:.4f} weight, expected 0, 0, "
+        "{:.4f}",
+        errors.bones, errors.sums, errors.max_weight, kMaxPackedWeight);
+    return false;
+  }
+  spdlog::info("mesh_pack_skin: {:.4f} weight", errors.max_weight);
+  return true;
+}
+
+// ObjectSystem::UploadObjectsToGpu without the Model and the GPU buffers
+
+struct BenchMesh {
+  GLuint packed_cmd_buffer_index_;
+  GLuint material_buffer_index_;
+};
+
+struct BenchModel {
+  MiVector<BenchMesh> meshes_;
+};
+
+struct BenchObject {
+  id::Object id;
+  GLuint props;
+  ObjectAddr addr;
+  glm::mat4 transformation;
+  const BenchModel* model;
+
+  id::Object GetId() const { return id; }
+  GLuint GetProps() const { return props; }
+  const ObjectAddr& GetAddr() const { return addr; }
+  glm::mat4 GetTransformation() const { return transformation; }
+  const BenchModel& GetModel() const { return *model; }
+};
+
+// BCn encoding, the same image for every format (the channels it stores)
+
+constexpr int kImageSize = 256;
+
+struct BlockFormat {
+  const char* name;
+  bc::Format::Enum format;
+  bc::Quality::Enum quality;
+  // compared by the PSNR check
+  int channels;
+  // the check fails below, dB
+  double min_psnr;
+};
+
+constexpr BlockFormat kBlockFormats[]{
+    {"texture_bc1_fast", bc::Format::kBC1, bc::Quality::kFast, 3, 34.0},
+    {"texture_bc1_high", bc::Format::kBC1, bc::Quality::kHigh, 3, 34.0},
+    {"texture_bc3_fast", bc::Format::kBC3, bc::Quality::kFast, 4, 35.0},
+    {"texture_bc3_high", bc::Format::kBC3, bc::Quality::kHigh, 4, 35.0},
+    {"texture_bc4_fast", bc::Format::kBC4, bc::Quality::kFast, 1, 45.0},
+    {"texture_bc4_high", bc::Format::kBC4, bc::Quality::kHigh, 1, 45.0},
+    {"texture_bc5_fast", bc::Format::kBC5, bc::Quality::kFast, 2, 45.0},
+    {"texture_bc5_high", bc::Format::kBC5, bc::Quality::kHigh, 2, 45.0},
+    {"texture_bc7_fast", bc::Format::kBC7, bc::Quality::kFast, 4, 36.0},
+    {"texture_bc7_high", bc::Format::kBC7, bc::Quality::kHigh, 4, 36.0},
+};
+
+// RGBA: smooth waves with noise, a checker and an alpha gradient
+MiVector<uint8_t> CreateImage() {
+  std::mt19937 prng(11);
+  std::normal_distribution<float> noise(0.0f, 6.0f);
+  MiVector<uint8_t> image(kImageSize * kImageSize * 4);
+  for (int y = 0; y < kImageSize; ++y) {
+    for (int x = 0; x < kImageSize; ++x) {
+      const float texel[4]{
+          128.0f + 100.0f * std::sin(x * 0.05f) + noise(prng),
+          128.0f + 100.0f * std::cos(y * 0.07f + x * 0.01f) + noise(prng),
+          ((x / 16 + y / 16) % 2) ? 200.0f : 40.0f,
+          x * 255.0f / kImageSize,
+      };
+      for (int c = 0; c < 4; ++c) {
+        image[(y * kImageSize + x) * 4 + c] =
+            static_cast<uint8_t>(std::clamp(std::lround(texel[c]), 0L, 255L));
+      }
+    }
+  }
+  return image;
+}
+
+// encoded and decoded with the reference decoder, false if any is too low
+bool CheckBlockCompression(const MiVector<uint8_t>& image) {
+  bool passed = true;
+  MiVector<uint8_t> blocks;
+  MiVector<uint8_t> decoded(image.size());
+  for (const auto& bench : kBlockFormats) {
+    blocks.resize(
+        bc::GetCompressedSize(bench.format, kImageSize, kImageSize));
+    bc::Encode(bench.format, bench.quality, image.data(), kImageSize,
+               kImageSize, kImageSize * 4, 4, blocks.data());
+    bc::Decode(bench.format, blocks.data(), kImageSize, kImageSize,
+               decoded.data());
+
+    double squared = 0.0;
+    for (size_t i = 0; i < image.size(); i += 4) {
+      for (int c = 0; c < bench.channels; ++c) {
+        const double d = decoded[i + c] - image[i + c];
+        squared += d * d;
+      }
+    }
+    const double mse = squared / (image.size() / 4 * bench.channels);
+    const double psnr = 10.0 * std::log10(255.0 * 255.0 / std::max(mse, 1e-9));
+    if (psnr < bench.min_psnr) {
+      spdlog::error("{}: PSNR {:.2f} dB, expected {:.2f} dB", bench.name, psnr,
+                    bench.min_psnr);
+      passed = false;
+    } else {
+      spdlog::info("{}: PSNR {:.2f} dB", bench.name, psnr);
+    }
+  }
+  return passed;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  // stdout is reserved for the CSV
+  spdlog::set_default_logger(spdlog::stderr_color_mt("bench"));
+  spdlog::set_pattern("[%^%l%$] %v");
+  const std::string filter = argc > 1 ? argv[1] : "";
+
+  const unsigned int workers = std::min(
+      static_cast<unsigned int>(kWorkers),
+      std::max(1U, std::thread::hardware_concurrency()));
+  // headless, no window and no OpenGL contexts
+  app::init::CreateWorkers(workers, 0);
+
+  MiVector<Benchmark> benchmarks;
+
+  // math::
+  constexpr size_t kPrimitives = 4096;
+  const CullingData culling = CreateCullingData(kPrimitives);
+  benchmarks.push_back({"math_aabb_in_frustum", kPrimitives, [&culling] {
+                          uint64_t visible = 0;
+                          for (const auto& box : culling.boxes) {
+                            visible +=
+                                math::AABBInFrustum(box, culling.frustum);
+                          }
+                          gSink = gSink + visible;
+                        }});
+  benchmarks.push_back({"math_sphere_in_frustum", kPrimitives, [&culling] {
+                          uint64_t visible = 0;
+                          for (const auto& sphere : culling.spheres) {
+                            visible +=
+                                math::SphereInFrustum(sphere, culling.frustum);
+                          }
+                          gSink = gSink + visible;
+                        }});
+  benchmarks.push_back({"math_ray_aabb", kPrimitives, [&culling] {
+                          uint64_t hits = 0;
+                          float dist = 0.0f;
+                          for (size_t i = 0; i < kPrimitives; ++i) {
+                            hits += math::RayAABB(culling.boxes[i],
+                                                  culling.rays[i], dist);
+                          }
+                          gSink = gSink + hits;
+                        }});
+  benchmarks.push_back({"math_aabb_aabb", kPrimitives, [&culling] {
+                          uint64_t hits = 0;
+                          for (size_t i = 1; i < kPrimitives; ++i) {
+                            hits += math::AABBAABB(culling.boxes[i - 1],
+                                                   culling.boxes[i]);
+                          }
+                          gSink = gSink + hits;
+                        }});
+
+  // Mesh vertex extraction
+  std::unique_ptr<aiMesh> mesh{CreateMesh()};
+  benchmarks.push_back({"mesh_extract_static", mesh->mNumVertices, [&mesh] {
+                          vertex::Stream<float> tex_coords;
+                          vertex::ExtractTexCoords(mesh.get(), tex_coords);
+                          vertex::Stream<unsigned int> indices;
+                          indices.reserve(mesh->mNumFaces * 3);
+                          vertex::ExtractIndices(mesh.get(), indices);
+                          gSink = gSink + tex_coords.size() + indices.size();
+                        }});
+  benchmarks.push_back({"mesh_extract_bone_weights", mesh->mNumVertices,
+                        [&mesh] {
+                          Skeleton skeleton(kBones);
+                          vertex::Stream<glm::ivec4> bones(mesh->mNumVertices,
+                                                           glm::ivec4(0));
+                          vertex::Stream<glm::vec4> weights(mesh->mNumVertices,
+                                                            glm::vec4(0.0f));
+                          vertex::ExtractBoneWeight(mesh.get(), skeleton,
+                                                    bones, weights);
+                          gSink = gSink + skeleton.bone_map.size();
+                        }});
+
+  // vertex cache, overdraw and vertex fetch order of the cooked models
+  const vertex::Stream<unsigned int> shuffled = ShuffleTriangles(mesh.get());
+  const std::span<const glm::vec3> positions{
+      reinterpret_cast<const glm::vec3*>(mesh->mVertices), mesh->mNumVertices};
+  const bool acmr_passed = CheckVertexCache(shuffled, positions);
+  benchmarks.push_back({"mesh_optimize_triangles", shuffled.size() / 3,
+                        [&shuffled, positions] {
+                          vertex::Stream<unsigned int> indices = shuffled;
+                          vertex::OptimizeTriangles(indices, positions);
+                          gSink = gSink + indices[0];
+                        }});
+  benchmarks.push_back({"mesh_optimize_vertex_fetch", mesh->mNumVertices,
+                        [&shuffled, positions] {
+                          vertex::Stream<unsigned int> indices = shuffled;
+                          vertex::Stream<unsigned int> remap;
+                          vertex::OptimizeVertexFetch(
+                              indices, positions.size(), remap);
+                          vertex::Stream<glm::vec3> remapped;
+                          vertex::RemapStream(positions, remap, 1, remapped);
+                          gSink = gSink + indices[0] + remap[0];
+                        }});
+
+  // compact vertices of the cooked static models
+  const MiVector<TangentFrame> frames = CreateTangentFrames(kPrimitives);
+  const bool packing_passed = CheckVertexFormat(frames);
+  MiVector<uint32_t> packed(frames.size() * 3);
+  benchmarks.push_back({"mesh_pack_vertices", frames.size(),
+                        [&frames, &packed] {
+                          for (size_t i = 0; i < frames.size(); ++i) {
+                            const auto& frame = frames[i];
+                            packed[i * 3 + 0] =
+                                vertex::PackNormal(frame.normal);
+                            packed[i * 3 + 1] = vertex::PackTangent(
+                                frame.normal, frame.tangent, frame.bitangent);
+                            packed[i * 3 + 2] = vertex::PackTexCoords(
+                                frame.tex_coords.x, frame.tex_coords.y);
+                          }
+                          gSink = gSink + packed[0];
+                        }});
+
+  // compact skin of the cooked skinned models
+  const SkinStreams skin = CreateSkin(mesh->mNumVertices);
+  const bool skin_passed = CheckSkin(skin);
+  vertex::Stream<glm::i16vec4> packed_bones(skin.bones.size());
+  vertex::Stream<glm::u8vec4> packed_weights(skin.weights.size());
+  benchmarks.push_back({"mesh_pack_skin", skin.bones.size(),
+                        [&skin, &packed_bones, &packed_weights] {
+                          for (size_t v = 0; v < skin.bones.size(); ++v) {
+                            packed_bones[v] = vertex::PackBones(skin.bones[v]);
+                            packed_weights[v] =
+                                vertex::PackWeights(skin.weights[v]);
+                          }
+                          gSink = gSink + packed_weights[0].x;
+                        }});
+
+  // Animation::PlayAnimation, many objects at different times
+  constexpr size_t kAnimated = 256;
+  Skeleton skeleton(kBones);
+  {
+    vertex::Stream<glm::ivec4> bones(mesh->mNumVertices, glm::ivec4(0));
+    vertex::Stream<glm::vec4> weights(mesh->mNumVertices, glm::vec4(0.0f));
+    vertex::ExtractBoneWeight(mesh.get(), skeleton, bones, weights);
+  }
+  std::unique_ptr<aiNode> root{CreateHierarchy()};
+  std::unique_ptr<aiAnimation> ai_animation{CreateAnimation()};
+  const Animation animation(ai_animation.get(), root.get(), skeleton);
+  MiVector<glm::mat4> bone_mat(kAnimated * animation.GetNumOfBones());
+  benchmarks.push_back(
+      {"animation_play", kAnimated, [&animation, &skeleton, &bone_mat] {
+         const size_t bones = animation.GetNumOfBones();
+         for (size_t i = 0; i < kAnimated; ++i) {
+           float time = std::fmod(i * 0.37f, animation.GetDuration());
+           std::span<glm::mat4> mat{bone_mat.begin() + i * bones, bones};
+           animation.PlayAnimation(skeleton, time, mat);
+         }
+         gSink = gSink + static_cast<uint64_t>(bone_mat.back()[3].y);
+       }});
+
+  // Shader::ParseShaderFile, every file (cold cache) and the cached lookup
+  const MiVector<fs::path> shaders = files::shaders.GetFilePaths();
+  if (shaders.empty()) {
+    spdlog::warn("no shaders in '{}', skipped", files::shaders.str);
+  } else {
+    benchmarks.push_back({"shader_parse", shaders.size(), [&shaders] {
+                            gl::Shader::ClearShaderCache();
+                            for (const auto& path : shaders) {
+                              auto code = gl::Shader::ParseShaderFile(path);
+                              gSink = gSink + code.body[0];
+                            }
+                          }});
+    benchmarks.push_back({"shader_parse_cached", shaders.size(), [&shaders] {
+                            for (const auto& path : shaders) {
+                              auto code = gl::Shader::ParseShaderFile(path);
+                              gSink = gSink + code.body[0];
+                            }
+                          }});
+  }
+
+  // ObjectSystem upload batching, 1-4 meshes per model
+  constexpr size_t kObjects = 16384;
+  MiVector<BenchModel> models(4);
+  for (GLuint m = 0; m < models.size(); ++m) {
+    for (GLuint i = 0; i <= m; ++i) {
+      models[m].meshes_.push_back({m * 4 + i, m * 4 + i});
+    }
+  }
+  MiVector<BenchObject> objects;
+  MiVector<BenchObject*> queue;
+  objects.reserve(kObjects);
+  GLuint instance = 1;
+  for (GLuint i = 0; i < kObjects; ++i) {
+    const auto& model = models[i % models.size()];
+    auto count = static_cast<GLuint>(model.meshes_.size());
+    glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3(i, 0.0f, 0.0f));
+    objects.push_back({i, 0, {count, instance, i, instance, 0}, world, &model});
+    queue.push_back(&objects.back());
+    instance += count;
+  }
+  SceneVector<GLuint> offsets;
+  SceneVector<gpu::Instance> instances;
+  SceneVector<glm::mat4> matrices;
+  benchmarks.push_back({"object_batch_instances", kObjects, [&] {
+                          BatchInstances(std::span<BenchObject* const>(queue),
+                                         offsets, instances, matrices);
+                          gSink = gSink + instances.back().box_index;
+                        }});
+
+  // task system
+  constexpr size_t kTasks = 10'000;
+  benchmarks.push_back({"task_push_wait", kTasks, [] {
+                          std::atomic<uint64_t> sum = 0;
+                          for (size_t i = 0; i < kTasks; ++i) {
+                            app::task::PushTask([&sum](int tid) {
+                              sum.fetch_add(tid + 1, std::memory_order_relaxed);
+                            });
+                          }
+                          app::task::WaitForTasks();
+                          gSink = gSink + sum.load();
+                        }});
+  constexpr size_t kElements = 1 << 20;
+  MiVector<float> elements(kElements, 1.0f);
+  benchmarks.push_back({"task_parallel_for", kElements, [&elements] {
+                          app::task::ParallelFor(
+                              elements.size(), [&elements](size_t begin,
+                                                           size_t end) {
+                                for (size_t i = begin; i < end; ++i) {
+                                  elements[i] = elements[i] * 0.5f + 0.5f;
+                                }
+                              });
+                          gSink = gSink + static_cast<uint64_t>(elements[0]);
+                        }});
+
+  // BCn encoding, parallel over the blocks
+  const MiVector<uint8_t> image = CreateImage();
+  const bool psnr_passed = CheckBlockCompression(image);
+  // 1 byte per texel, the largest of the formats
+  MiVector<uint8_t> blocks(kImageSize * kImageSize);
+  for (const auto& format : kBlockFormats) {
+    benchmarks.push_back(
+        {format.name, kImageSize * kImageSize, [&image, &blocks, &format] {
+           bc::Encode(format.format, format.quality, image.data(), kImageSize,
+                      kImageSize, kImageSize * 4, 4, blocks.data());
+           gSink = gSink + blocks[0];
+         }});
+  }
+
+  fmt::print("benchmark,items,calls,median_ns_per_item,min_ns_per_item\n");
+  for (const auto& bench : benchmarks) {
+    if (std::string_view(bench.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    Run(bench);
+  }
+
+  app::init::DestroyWorkers();
+  const bool passed =
+      psnr_passed && acmr_passed && packing_passed && skin_passed;
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// deps
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+// global
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+// local
+#include "app/task_system.h"
+#include "mi_types.h"
+
+// push-to-start latency of a single task after a quiet period
+// the gap lets the idle workers go from spinning to parked
+
+namespace {
+
+using namespace std::chrono;
+using fus = duration<float, std::micro>;
+
+constexpr int kWorkers = 4;
+
+struct Gap {
+  microseconds duration;
+  int samples;
+};
+
+// back-to-back, inside the spin window, parked
+constexpr Gap kGaps[]{{microseconds(0), 20'000},
+                      {microseconds(50), 5'000},
+                      {microseconds(1'000), 1'000},
+                      {microseconds(10'000), 200}};
+
+float Percentile(MiVector<float>& sorted, float p) {
+  auto index = static_cast<size_t>(p * (sorted.size() - 1));
+  return sorted[index];
+}
+
+MiVector<float> Measure(const Gap& gap) {
+  MiVector<float> latency_us;
+  latency_us.reserve(gap.samples);
+
+  for (int i = 0; i < gap.samples; ++i) {
+    if (gap.duration.count()) {
+      std::this_thread::sleep_for(gap.duration);
+    }
+    std::atomic<int64_t> started = 0;
+    auto pushed = steady_clock::now();
+    app::task::PushTask([&started](int) {
+      started = steady_clock::now().time_since_epoch().count();
+    });
+    app::task::WaitForTasks();
+
+    steady_clock::time_point start{steady_clock::duration(started.load())};
+    latency_us.push_back(duration_cast<fus>(start - pushed).count());
+  }
+  return latency_us;
+}
+
+}  // namespace
+
+int main() {
+  spdlog::set_pattern("[%^%l%$] %v");
+
+  const unsigned int workers = std::min(
+      static_cast<unsigned int>(kWorkers),
+      std::max(1U, std::thread::hardware_concurrency()));
+  // headless, no window and no OpenGL contexts
+  app::init::CreateWorkers(workers, 0);
+
+  fmt::print("gap_us,workers,samples,p50_us,p99_us,max_us\n");
+  for (const auto& gap : kGaps) {
+    auto latency_us = Measure(gap);
+    std::sort(latency_us.begin(), latency_us.end());
+    fmt::print("{},{},{},{:.2f},{:.2f},{:.2f}\n", gap.duration.count(),
+               workers, gap.samples, Percentile(latency_us, 0.5f),
+               Percentile(latency_us, 0.99f), latency_us.back());
+  }
+
+  app::init::DestroyWorkers();
+  return 0;
+}
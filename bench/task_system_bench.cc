@@ -0,0 +1,88 @@
+// deps
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+// global
+#include <atomic>
+#include <cmath>
+#include <thread>
+// local
+#include "app/task_system.h"
+#include "utils/profiling.h"
+
+// throughput of many small tasks, 1 to N workers
+// flat: the main thread pushes every task (shared queue)
+// nested: few root tasks spawn the rest (worker deques, stealing)
+
+namespace {
+
+constexpr int kTasks = 200'000;
+constexpr int kRootTasks = 64;
+// ~1-2 us of work per task
+constexpr int kWorkIterations = 256;
+
+std::atomic<float> gSink = 0.0f;
+
+void SmallWork(int seed) {
+  float acc = static_cast<float>(seed);
+  for (int i = 0; i < kWorkIterations; ++i) {
+    acc = std::sin(acc) + 1.0f;
+  }
+  gSink.store(acc, std::memory_order_relaxed);
+}
+
+void Flat() {
+  for (int i = 0; i < kTasks; ++i) {
+    app::task::PushTask([i](int) { SmallWork(i); });
+  }
+  app::task::WaitForTasks();
+}
+
+void Nested() {
+  constexpr int children = kTasks / kRootTasks;
+  for (int r = 0; r < kRootTasks; ++r) {
+    app::task::PushTask([r](int) {
+      for (int i = 0; i < children; ++i) {
+        app::task::PushTask([r, i](int) { SmallWork(r * children + i); });
+      }
+    });
+  }
+  app::task::WaitForTasks();
+}
+
+struct Scenario {
+  const char* name;
+  void (*run)();
+};
+
+}  // namespace
+
+int main() {
+  spdlog::set_pattern("[%^%l%$] %v");
+
+  const unsigned int max_workers =
+      std::max(1U, std::thread::hardware_concurrency());
+  const Scenario scenarios[]{{"flat", Flat}, {"nested", Nested}};
+
+  fmt::print("scenario,workers,tasks,ms,tasks_per_sec,speedup\n");
+  for (const auto& scenario : scenarios) {
+    float single_ms = 0.0f;
+    for (unsigned int workers = 1; workers <= max_workers; ++workers) {
+      // headless, no window and no OpenGL contexts
+      app::init::CreateWorkers(workers, 0);
+      // warm up the queues and the allocator
+      scenario.run();
+
+      prof::Counter counter;
+      scenario.run();
+      counter.End();
+      app::init::DestroyWorkers();
+
+      float ms = counter.GetTime<prof::fms>();
+      if (workers == 1) single_ms = ms;
+      fmt::print("{},{},{},{:.3f},{:.0f},{:.2f}\n", scenario.name, workers,
+                 kTasks, ms, kTasks / (ms * 0.001f), single_ms / ms);
+    }
+  }
+
+  return 0;
+}
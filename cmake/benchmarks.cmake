@@ -0,0 +1,72 @@
+# standalone benchmarks, built only with -DBUILD_BENCHMARKS=ON
+# every benchmark is a separate executable that links the engine sources
+# it measures directly, without the Engine, UI and renderer
+# headless workers (no window, no OpenGL context), runs on Linux too
+
+# task system: throughput scaling from 1 to N workers
+add_executable(TaskSystemBench
+    bench/task_system_bench.cc
+    src/app/cpu_topology.cc
+    src/app/parameters.cc
+    src/app/task_system.cc
+    src/utils/profiling.cc
+)
+
+# task system: push-to-start latency of the idle workers
+add_executable(TaskLatencyBench
+    bench/task_latency_bench.cc
+    src/app/cpu_topology.cc
+    src/app/parameters.cc
+    src/app/task_system.cc
+    src/utils/profiling.cc
+)
+
+# CPU hot paths with synthetic data: math, animation, shader parsing,
+# vertex extraction, vertex cache optimization and packing, instance
+# batching, BCn encoding (with the PSNR check)
+# and the task system (CSV output)
+add_executable(HotPathsBench
+    bench/hot_paths_bench.cc
+    src/app/cpu_topology.cc
+    src/app/parameters.cc
+    src/app/task_system.cc
+    src/assets/animation.cc
+    src/assets/block_compression.cc
+    src/assets/vertex_cache.cc
+    src/assets/vertex_data.cc
+    src/assets/vertex_format.cc
+    src/files.cc
+    src/math/collision_types.cc
+    src/math/fast_math.cc
+    src/math/intersection.cc
+    src/math/transformation.cc
+    src/mem_info.cc
+    src/opengl/shader.cc
+    src/utils/metrics.cc
+    src/utils/profiling.cc
+)
+target_link_libraries(HotPathsBench PRIVATE
+    assimp::assimp
+    magic_enum::magic_enum
+)
+
+set(BENCHMARK_TARGETS TaskSystemBench TaskLatencyBench HotPathsBench)
+
+foreach(target ${BENCHMARK_TARGETS})
+    target_compile_features(${target} PRIVATE c_std_17 cxx_std_20)
+    target_include_directories(${target} PRIVATE src bench)
+    target_compile_definitions(${target} PRIVATE
+        $<$<CXX_COMPILER_ID:MSVC>:_WIN32_WINNT=0x0A00>
+    )
+    target_link_libraries(${target} PRIVATE
+        mimalloc # must be first
+        fmt::fmt
+        glad::glad
+        glm::glm
+        spdlog::spdlog
+    )
+    # WGL symbols of the task system
+    if(WIN32)
+        target_link_libraries(${target} PRIVATE OpenGL::GL)
+    endif()
+endforeach()
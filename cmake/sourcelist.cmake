@@ -1,14 +1,19 @@
 set(SOURCES
     src/app/application.cc
     src/app/application.h
+    src/app/coro.h
+    src/app/cpu_topology.cc
+    src/app/cpu_topology.h
     src/app/ini.cc
     src/app/ini.h
     src/app/input.cc
     src/app/input.h
     src/app/main_thread.cc
     src/app/main_thread.h
+    src/app/parallel.h
     src/app/parameters.cc
     src/app/parameters.h
+    src/app/task_queue.h
     src/app/task_system.cc
     src/app/task_system.h
 
@@ -17,21 +22,37 @@ set(SOURCES
     src/assets/assets.cc
     src/assets/assets.h
     src/assets/assimp_blender.h
+    src/assets/block_compression.cc
+    src/assets/block_compression.h
+    src/assets/cooked_blob.cc
+    src/assets/cooked_blob.h
     src/assets/env_texture_manager.cc
     src/assets/env_texture_manager.h
+    src/assets/loading_report.cc
+    src/assets/loading_report.h
     src/assets/mesh.cc
     src/assets/mesh.h
     src/assets/model.cc
     src/assets/model.h
+    src/assets/model_cache.cc
+    src/assets/model_cache.h
     src/assets/model_manager.cc
     src/assets/model_manager.h
     src/assets/particle_manager.cc
     src/assets/particle_manager.h
     src/assets/stb_image.cc
+    src/assets/texture_cache.cc
+    src/assets/texture_cache.h
     src/assets/texture_manager.cc
     src/assets/texture_manager.h
     src/assets/texture.cc
     src/assets/texture.h
+    src/assets/vertex_cache.cc
+    src/assets/vertex_cache.h
+    src/assets/vertex_data.cc
+    src/assets/vertex_data.h
+    src/assets/vertex_format.cc
+    src/assets/vertex_format.h
 
     src/math/assimp_to_glm.h
     src/math/collision_types.cc
@@ -87,6 +108,7 @@ set(SOURCES
 
     src/scene/camera_system.cc
     src/scene/camera_system.h
+    src/scene/instance_batch.h
     src/scene/light_system.cc
     src/scene/light_system.h
     src/scene/object_system.cc
@@ -122,9 +144,14 @@ set(SOURCES
     src/ui/win_settings.cc
     src/ui/win_settings.h
 
+    src/utils/alloc_tracking.cc
+    src/utils/alloc_tracking.h
     src/utils/enums.h
+    src/utils/metrics.cc
+    src/utils/metrics.h
     src/utils/output.cc
     src/utils/output.h
+    src/utils/profiling.cc
     src/utils/profiling.h
     src/utils/string_parsing.cc
     src/utils/string_parsing.h
@@ -56,6 +56,7 @@
 #define CLUSTERS_TOTAL 3456
 #define MAX_POINT_LIGHTS_PER_CLUSTER 64
 #define DEBUG_READBACK_SIZE 32
+#define COMPACT_VERTICES 1
 // Props flags
 #define ENABLED 1
 #define VISIBLE 2
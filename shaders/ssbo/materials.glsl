@@ -49,8 +49,10 @@ float GetAlpha(Material mat, vec2 uv) {
 vec3 GetNormals(Material mat, vec2 uv) {
   if (bool(mat.tex_flags & kNormals)) {
     sampler2D tex_normals = sampler2D(mat.hnd_normals);
-    vec3 normal_map = texture(tex_normals, uv).xyz;
-    return normalize(normal_map * 2.0 - 1.0);
+    // BC5 stores XY only, Z of the tangent space is always positive
+    vec2 normal_map = texture(tex_normals, uv).xy * 2.0 - 1.0;
+    float z = sqrt(max(1.0 - dot(normal_map, normal_map), 0.0));
+    return normalize(vec3(normal_map, z));
   } else {
     return vec3(0.0, 0.0, 1.0);
   }
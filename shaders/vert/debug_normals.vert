@@ -37,6 +37,7 @@ vs_out;
 #define STORAGE_ANIMATIONS readonly
 #include "shaders/ssbo/animations.glsl"
 #include "shaders/ssbo/matrices.glsl"
+#include "shaders/vertex.glsl"
 
 float AverageScale() {
   mat4 model = sWorld[aMatrixIndex];
@@ -57,7 +58,7 @@ void main() {
   // remove translation part
   mat3 normal_mat = transpose(inverse(mat3(view_model)));
   float avg_scale = AverageScale();
-  vec3 normal = normalize(normal_mat * aNormal) *
+  vec3 normal = normalize(normal_mat * GetNormal()) *
                 uDebugNormalsColorMagnitude.a * avg_scale;
   vec4 normal_pos = view_pos + vec4(normal, 0.0);
   // clip-space
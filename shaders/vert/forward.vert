@@ -37,6 +37,7 @@ vs_out;
 #include "shaders/ssbo/animations.glsl"
 #include "shaders/ssbo/matrices.glsl"
 #include "shaders/ssbo/visibility.glsl"
+#include "shaders/vertex.glsl"
 
 // forward rendering in tangent space is slower by 5-10%
 void main() {
@@ -51,9 +52,13 @@ void main() {
   mat3 normal_matrix = transpose(inverse(mat3(model)));
 #endif
 
-  vec3 N = normalize(normal_matrix * aNormal);
-  vec3 T = normalize(normal_matrix * aTangent);
-  vec3 B = normalize(normal_matrix * aBitangent);
+  vec3 normal = GetNormal();
+  vec3 tangent;
+  vec3 bitangent;
+  GetTangents(normal, tangent, bitangent);
+  vec3 N = normalize(normal_matrix * normal);
+  vec3 T = normalize(normal_matrix * tangent);
+  vec3 B = normalize(normal_matrix * bitangent);
 
   vs_out.frag_pos = model * local_pos;
   vs_out.tangent_to_world = mat3(T, B, N);
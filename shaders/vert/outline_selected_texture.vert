@@ -10,6 +10,8 @@
 // in
 layout(location = 0) in vec4 aPosition;
 layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec3 aTangent;
+layout(location = 3) in vec3 aBitangent;
 layout(location = 4) in vec2 aTexCoords;
 layout(location = 6) in ivec4 aBonesIds;
 layout(location = 7) in vec4 aWeights;
@@ -27,6 +29,7 @@ vs_out;
 // ssbo
 #define STORAGE_ANIMATIONS readonly
 #include "shaders/ssbo/animations.glsl"
+#include "shaders/vertex.glsl"
 
 // uniform
 layout(location = 0) uniform mat4 uModel;
@@ -43,6 +46,6 @@ void main() {
 #endif
 
   vs_out.tex_coords = aTexCoords;
-  vs_out.view_normal = normal_matrix_view * aNormal;
+  vs_out.view_normal = normal_matrix_view * GetNormal();
   gl_Position = uProjView * uModel * local_pos;
 };
@@ -0,0 +1,32 @@
+// the tangent frame of aNormal, aTangent and aBitangent (declared before)
+// COMPACT_VERTICES, static meshes: octahedral snorm16x2 in .xy, the sign
+// of the tangent's y is the sign of the bitangent, see
+// src/assets/vertex_format.h
+
+vec3 OctDecode(vec2 e) {
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0);
+  n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+  return normalize(n);
+}
+
+vec3 GetNormal() {
+#if COMPACT_VERTICES && !defined(SKINNED)
+  return OctDecode(aNormal.xy);
+#else
+  return aNormal;
+#endif
+}
+
+void GetTangents(vec3 normal, out vec3 tangent, out vec3 bitangent) {
+#if COMPACT_VERTICES && !defined(SKINNED)
+  vec2 e = aTangent.xy;
+  float sign = e.y < 0.0 ? -1.0 : 1.0;
+  e.y = abs(e.y) * 2.0 - 1.0;
+  tangent = OctDecode(e);
+  bitangent = cross(normal, tangent) * sign;
+#else
+  tangent = aTangent;
+  bitangent = aBitangent;
+#endif
+}
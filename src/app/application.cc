@@ -23,6 +23,8 @@
 #include "app/main_thread.h"
 #include "app/parameters.h"
 #include "app/task_system.h"
+#include "mem_info.h"
+#include "utils/profiling.h"
 
 namespace app {
 
@@ -181,6 +183,7 @@ class CloseApplication {
 bool Application() {
   // the same as default but without date-time
   spdlog::set_pattern("[%^%l%$] %v");
+  prof::SetThreadName("Main Thread");
 
   // GLFW the first
   if (!glfwInit()) {
@@ -281,8 +284,11 @@ bool Application() {
   // OpenGL GPU parameters after GLAD
   app::set::GetOpenGlParameters();
 
-  // create ImGui's context
+  // create ImGui's context, its allocations are counted to the UI
   IMGUI_CHECKVERSION();
+  ImGui::SetAllocatorFunctions(
+      [](size_t size, void*) { return mem::Allocate(mem::Tag::kUi, size); },
+      [](void* ptr, void*) { mem::Free(mem::Tag::kUi, ptr); });
   ImGui::CreateContext();
 
   // init the ImGui's backends
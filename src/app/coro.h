@@ -0,0 +1,202 @@
+#pragma once
+
+// global
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <utility>
+// local
+#include "app/main_thread.h"
+#include "app/task_system.h"
+#include "mi_types.h"
+
+namespace app {
+
+namespace coro {
+
+// lazy coroutine, starts when awaited or spawned
+// a suspended task doesn't hold a worker (no future.get())
+template <typename T = void>
+class Task;
+
+// the awaiting coroutine continues on the thread that finished the task
+struct PromiseBase {
+  std::coroutine_handle<> continuation{std::noop_coroutine()};
+
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename P>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<P> handle) noexcept {
+      return handle.promise().continuation;
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+  // the engine doesn't use exceptions
+  void unhandled_exception() noexcept { std::terminate(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+  std::optional<T> value;
+
+  void return_value(T result) { value = std::move(result); }
+  T Result() { return std::move(*value); }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+  void return_void() noexcept {}
+  void Result() noexcept {}
+};
+
+template <typename T>
+class [[nodiscard]] Task {
+ public:
+  struct promise_type : Promise<T> {
+    Task get_return_object() noexcept {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+  };
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  ~Task() {
+    if (handle_) handle_.destroy();
+  }
+
+ public:
+  // co_await starts the task (symmetric transfer, no stack growth)
+  bool await_ready() const noexcept { return false; }
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> caller) noexcept {
+    handle_.promise().continuation = caller;
+    return handle_;
+  }
+  T await_resume() { return handle_.promise().Result(); }
+
+ private:
+  explicit Task(Handle handle) : handle_(handle) {}
+  Handle handle_;
+};
+
+// resumes on a worker, no-op if already on one
+// returns the worker index (per-thread resources, e.g. importers)
+// the priority of the current task by default, kNormal on the main thread
+struct SwitchToWorker {
+  task::Priority::Enum priority = task::GetPriority();
+
+  bool await_ready() const noexcept { return task::GetWorkerIndex() >= 0; }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    task::PushTask([handle](int) { handle.resume(); }, priority);
+  }
+  int await_resume() const noexcept { return task::GetWorkerIndex(); }
+};
+
+// resumes on a worker with OpenGL context (uploads), no-op if already on one
+// headless pools resume on a CPU worker (task::PushGlTask)
+struct SwitchToGlWorker {
+  bool await_ready() const noexcept { return task::IsGlWorker(); }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    task::PushGlTask([handle](int) { handle.resume(); });
+  }
+  int await_resume() const noexcept { return task::GetWorkerIndex(); }
+};
+
+// resumes on the main thread (main OpenGL context), no-op if already on it
+// switch back to a worker after the GL calls, the main thread renders
+struct SwitchToMainThread {
+  bool await_ready() const noexcept { return main_thread::IsMainThread(); }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    std::packaged_task<void()> package([handle]() { handle.resume(); });
+    // nobody waits for the future, the coroutine continues instead
+    main_thread::PushTask(package);
+  }
+  void await_resume() const noexcept {}
+};
+
+// fire-and-forget root, destroys itself when finished
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+// unconditional hop to the workers (the caller must not run the task inline)
+struct Schedule {
+  task::Priority::Enum priority = task::GetPriority();
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    task::PushTask([handle](int) { handle.resume(); }, priority);
+  }
+  void await_resume() const noexcept {}
+};
+
+inline Detached RunDetached(Task<void> task, task::Group &group,
+                            task::Priority::Enum priority) {
+  co_await Schedule{priority};
+  co_await task;
+  group.Finish();
+}
+
+// starts the task on a worker, group.Wait() returns when it's finished
+inline void Spawn(task::Group &group, Task<void> task,
+                  task::Priority::Enum priority = task::GetPriority()) {
+  group.Add();
+  RunDetached(std::move(task), group, priority);
+}
+
+// starts all tasks on the workers (the caller priority), the caller
+// continues on the thread that finished the last one
+class WhenAll {
+ public:
+  explicit WhenAll(MiVector<Task<void>> &tasks) : tasks_(tasks) {}
+
+ public:
+  bool await_ready() const noexcept { return tasks_.empty(); }
+  bool await_suspend(std::coroutine_handle<> caller) {
+    caller_ = caller;
+    // +1 keeps the caller suspended until all tasks are pushed
+    pending_ = static_cast<int>(tasks_.size()) + 1;
+    for (auto &task : tasks_) {
+      RunChild(task, *this);
+    }
+    // false: all tasks are already finished, continue inline
+    return --pending_ != 0;
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  MiVector<Task<void>> &tasks_;
+  std::coroutine_handle<> caller_;
+  std::atomic<int> pending_{0};
+
+  static Detached RunChild(Task<void> &task, WhenAll &all) {
+    co_await Schedule{};
+    co_await task;
+    if (--all.pending_ == 0) {
+      all.caller_.resume();
+    }
+  }
+};
+
+}  // namespace coro
+
+}  // namespace app
@@ -0,0 +1,194 @@
+#include "cpu_topology.h"
+
+// os
+#if defined(_WIN32)
+#define _AMD64_
+#include <windef.h>
+#include <processthreadsapi.h>
+#include <processtopologyapi.h>
+#include <sysinfoapi.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+// deps
+#include <spdlog/spdlog.h>
+// global
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace app {
+
+namespace topology {
+
+namespace {
+
+#if defined(_WIN32)
+bool Detect(Topology& topo) {
+  DWORD length = 0;
+  GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+  MiVector<uint8_t> buffer(length);
+  auto* info =
+      reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+  if (!GetLogicalProcessorInformationEx(RelationAll, info, &length)) {
+    return false;
+  }
+
+  MiVector<GROUP_AFFINITY> l3_masks;
+  unsigned int core = 0;
+  for (DWORD offset = 0; offset < length; offset += info->Size) {
+    info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(
+        buffer.data() + offset);
+    if (info->Relationship == RelationProcessorCore) {
+      // a core belongs to one group
+      const GROUP_AFFINITY& mask = info->Processor.GroupMask[0];
+      for (unsigned int bit = 0; bit < 64; ++bit) {
+        if (mask.Mask & (KAFFINITY{1} << bit)) {
+          topo.processors.push_back({mask.Group * 64U + bit, core, 0});
+        }
+      }
+      ++core;
+    } else if (info->Relationship == RelationCache &&
+               info->Cache.Level == 3) {
+      l3_masks.push_back(info->Cache.GroupMask);
+    }
+  }
+
+  for (auto& processor : topo.processors) {
+    for (unsigned int l3 = 0; l3 < l3_masks.size(); ++l3) {
+      const auto& mask = l3_masks[l3];
+      if (mask.Group == processor.id / 64 &&
+          (mask.Mask & (KAFFINITY{1} << (processor.id % 64)))) {
+        processor.l3 = l3;
+        break;
+      }
+    }
+  }
+  return !topo.processors.empty();
+}
+#elif defined(__linux__)
+// first number of "0-7,16-23" or "5", -1 if missing
+int ReadFirstNumber(const std::string& path) {
+  std::ifstream file(path);
+  int value = -1;
+  file >> value;
+  return value;
+}
+
+bool Detect(Topology& topo) {
+  const std::string root = "/sys/devices/system/cpu/cpu";
+  MiVector<int> core_keys;
+  MiVector<int> l3_keys;
+  const unsigned int count = std::thread::hardware_concurrency();
+  for (unsigned int id = 0; id < count; ++id) {
+    const std::string cpu = root + std::to_string(id);
+    int core_id = ReadFirstNumber(cpu + "/topology/core_id");
+    int package = ReadFirstNumber(cpu + "/topology/physical_package_id");
+    if (core_id < 0) return false;
+    // L3 is identified by the first processor that shares it
+    int l3_key = ReadFirstNumber(cpu + "/cache/index3/shared_cpu_list");
+
+    int core_key = (std::max(package, 0) << 16) | core_id;
+    auto core = std::find(core_keys.begin(), core_keys.end(), core_key);
+    if (core == core_keys.end()) {
+      core = core_keys.insert(core_keys.end(), core_key);
+    }
+    auto l3 = std::find(l3_keys.begin(), l3_keys.end(), l3_key);
+    if (l3 == l3_keys.end()) {
+      l3 = l3_keys.insert(l3_keys.end(), l3_key);
+    }
+    topo.processors.push_back(
+        {id, static_cast<unsigned int>(core - core_keys.begin()),
+         static_cast<unsigned int>(l3 - l3_keys.begin())});
+  }
+  return !topo.processors.empty();
+}
+#else
+bool Detect(Topology& topo) { return false; }
+#endif
+
+Topology DetectTopology() {
+  Topology topo;
+  if (!Detect(topo)) {
+    spdlog::warn("{}: CPU topology isn't available, no SMT and L3 info",
+                 __FUNCTION__);
+    topo.processors.clear();
+    const unsigned int count =
+        std::max(1U, std::thread::hardware_concurrency());
+    for (unsigned int id = 0; id < count; ++id) {
+      topo.processors.push_back({id, id, 0});
+    }
+  }
+
+  for (const auto& processor : topo.processors) {
+    topo.physical_cores = std::max(topo.physical_cores, processor.core + 1);
+    topo.l3_groups = std::max(topo.l3_groups, processor.l3 + 1);
+  }
+  return topo;
+}
+
+}  // namespace
+
+const Topology& Get() {
+  static const Topology topo = DetectTopology();
+  return topo;
+}
+
+unsigned int GetMainProcessor() { return Get().processors.front().id; }
+
+MiVector<unsigned int> GetPlacement(unsigned int threads) {
+  const auto& topo = Get();
+  MiVector<Processor> sorted = topo.processors;
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const Processor& a, const Processor& b) {
+                     if (a.l3 != b.l3) return a.l3 < b.l3;
+                     return a.core < b.core;
+                   });
+
+  const unsigned int main_core = topo.processors.front().core;
+  MiVector<unsigned int> primary;
+  MiVector<unsigned int> siblings;
+  MiVector<unsigned int> main_siblings;
+  unsigned int last_core = ~0U;
+  for (const auto& processor : sorted) {
+    if (processor.core == main_core) {
+      main_siblings.push_back(processor.id);
+    } else if (processor.core != last_core) {
+      primary.push_back(processor.id);
+    } else {
+      siblings.push_back(processor.id);
+    }
+    last_core = processor.core;
+  }
+  primary.insert(primary.end(), siblings.begin(), siblings.end());
+  // the main core is the last resort (single core machines)
+  primary.insert(primary.end(), main_siblings.begin(), main_siblings.end());
+
+  MiVector<unsigned int> placement(threads);
+  for (unsigned int tid = 0; tid < threads; ++tid) {
+    placement[tid] = primary[tid % primary.size()];
+  }
+  return placement;
+}
+
+bool PinThread(unsigned int id) {
+#if defined(_WIN32)
+  GROUP_AFFINITY affinity{};
+  affinity.Mask = KAFFINITY{1} << (id % 64);
+  affinity.Group = static_cast<WORD>(id / 64);
+  return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#elif defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(id, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace topology
+
+}  // namespace app
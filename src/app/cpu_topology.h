@@ -0,0 +1,38 @@
+#pragma once
+
+// local
+#include "mi_types.h"
+
+namespace app {
+
+namespace topology {
+
+// logical processor (SMT thread)
+struct Processor {
+  // OS index, group * 64 + number on Windows
+  unsigned int id{0};
+  // physical core and shared L3 cache (CCX on Zen)
+  unsigned int core{0};
+  unsigned int l3{0};
+};
+
+struct Topology {
+  MiVector<Processor> processors;
+  unsigned int physical_cores{1};
+  unsigned int l3_groups{1};
+};
+
+// detected once, without OS support every processor is a core
+const Topology& Get();
+// processor ids for the workers: one per physical core first, ordered
+// by L3 (neighbour workers steal from each other), then SMT siblings
+// the first core is left to the main thread
+MiVector<unsigned int> GetPlacement(unsigned int threads);
+// processor id for the main thread
+unsigned int GetMainProcessor();
+// pins the calling thread, false if the OS refused
+bool PinThread(unsigned int id);
+
+}  // namespace topology
+
+}  // namespace app
@@ -1,14 +1,14 @@
 #include "main_thread.h"
 
 // global
+#include <algorithm>
 #include <atomic>
-#include <mutex>
-#include <queue>
+#include <cstdint>
+#include <thread>
 // local
-#include "mi_types.h"
-
-template <typename T>
-using MiQueue = std::queue<T, std::deque<T, mi_stl_allocator<T>>>;
+#include "app/parameters.h"
+#include "app/task_queue.h"
+#include "utils/profiling.h"
 
 namespace app {
 
@@ -16,18 +16,43 @@ namespace main_thread {
 
 namespace {
 
+struct Task {
+  std::packaged_task<void()> package;
+  prof::steady_clock::time_point pushed;
+};
+
+constexpr int kStatsFrames = 20;
+
+struct StatsAccum {
+  int frames{0};
+  int executed{0};
+  int carried{0};
+  int over_budget{0};
+  float busy_ms{0.0f};
+  float latency_sum_ms{0.0f};
+  float latency_max_ms{0.0f};
+};
+
 std::thread::id gId = std::this_thread::get_id();
-std::mutex gMutex;
-MiQueue<std::packaged_task<void()>> gTasks;
+MpscQueue<Task> gTasks;
 std::atomic<int> gTasksTotal = 0;
+// bumped by every push and Wake(), DrainTasksUntil() sleeps on it
+std::atomic<uint32_t> gWakeEpoch = 0;
+// main thread only
+StatsAccum gAccum;
+Stats gStats;
 
-bool PopTask(std::packaged_task<void()>& task) {
-  std::scoped_lock lock(gMutex);
-  if (gTasks.empty()) return false;
+void ProcessStats() {
+  auto& a = gAccum;
+  if (++a.frames < kStatsFrames) return;
 
-  task = std::move(gTasks.front());
-  gTasks.pop();
-  return true;
+  gStats.executed = static_cast<float>(a.executed) / kStatsFrames;
+  gStats.busy_ms = a.busy_ms / kStatsFrames;
+  gStats.carried = static_cast<float>(a.carried) / kStatsFrames;
+  gStats.latency_avg_ms = (a.executed) ? a.latency_sum_ms / a.executed : 0.0f;
+  gStats.latency_max_ms = a.latency_max_ms;
+  gStats.over_budget = a.over_budget;
+  a = StatsAccum{};
 }
 
 }  // namespace
@@ -39,26 +64,68 @@ bool IsMainThread() {
 
 int GetTasksTotal() { return gTasksTotal; }
 
+const Stats& GetStats() { return gStats; }
+
 std::future<void> PushTask(std::packaged_task<void()>& package) {
   gTasksTotal++;
   std::future<void> future = package.get_future();
-  {
-    std::scoped_lock lock(gMutex);
-    gTasks.push(std::move(package));
-  }
+  gTasks.Push(Task{std::move(package), prof::steady_clock::now()});
+  Wake();
   return future;
 }
 
 void ExecuteTasks() {
-  while (gTasksTotal) {
-    std::packaged_task<void()> task;
-    if (PopTask(task)) {
-      task();
-      --gTasksTotal;
+  prof::Zone zone("Main Thread Tasks");
+  prof::Counter frame;
+  const float budget_ms = app::cpu.main_thread_budget_ms;
+
+  Task task;
+  while (gTasks.TryPop(task)) {
+    float latency_ms =
+        prof::duration_cast<prof::fms>(prof::steady_clock::now() - task.pushed)
+            .count();
+    gAccum.latency_sum_ms += latency_ms;
+    gAccum.latency_max_ms = std::max(gAccum.latency_max_ms, latency_ms);
+
+    task.package();
+    --gTasksTotal;
+    ++gAccum.executed;
+
+    // leftovers wait for the next frame
+    if (frame.GetElapsed<prof::fms>() >= budget_ms) {
+      if (gTasksTotal) ++gAccum.over_budget;
+      break;
     }
   }
+
+  gAccum.busy_ms += frame.GetElapsed<prof::fms>();
+  gAccum.carried += gTasksTotal;
+  ProcessStats();
+}
+
+void DrainTasks() {
+  Task task;
+  while (gTasks.TryPop(task)) {
+    task.package();
+    --gTasksTotal;
+  }
+}
+
+void DrainTasksUntil(const std::function<bool()>& ready) {
+  for (;;) {
+    // read before the checks, a push or Wake() after them changes it
+    uint32_t epoch = gWakeEpoch.load(std::memory_order_acquire);
+    DrainTasks();
+    if (ready()) return;
+    gWakeEpoch.wait(epoch, std::memory_order_acquire);
+  }
+}
+
+void Wake() {
+  gWakeEpoch.fetch_add(1, std::memory_order_release);
+  gWakeEpoch.notify_one();
 }
 
 }  // namespace main_thread
 
-}  // namespace app
\ No newline at end of file
+}  // namespace app
@@ -1,16 +1,41 @@
 #pragma once
 
 // global
+#include <functional>
 #include <future>
 
 namespace app {
 
 namespace main_thread {
 
+// averaged over kStatsFrames frames (to tune the budget)
+struct Stats {
+  // per frame
+  float executed{0.0f};
+  float busy_ms{0.0f};
+  // left in the queue at the end of the frame
+  float carried{0.0f};
+  // push to start
+  float latency_avg_ms{0.0f};
+  float latency_max_ms{0.0f};
+  // frames that ran out of the budget
+  int over_budget{0};
+};
+
 bool IsMainThread();
 int GetTasksTotal();
+const Stats& GetStats();
 std::future<void> PushTask(std::packaged_task<void()>& package);
+// runs the tasks until app::cpu.main_thread_budget_ms is spent,
+// at least one task per frame
 void ExecuteTasks();
+// all the queued tasks, no budget and no stats (not a frame)
+// for the main thread blocked on a worker, can run inside a task
+void DrainTasks();
+// DrainTasks() until ready(), sleeps between the pushes (no polling)
+// the worker that makes ready() true calls Wake()
+void DrainTasksUntil(const std::function<bool()>& ready);
+void Wake();
 
 }  // namespace main_thread
 
@@ -0,0 +1,73 @@
+#pragma once
+
+// global
+#include <algorithm>
+// local
+#include "app/task_system.h"
+#include "mi_types.h"
+
+namespace app {
+
+namespace task {
+
+// the chunks depend on the range only, not on the number of workers:
+// the same chunks and the same order of combine (deterministic results)
+inline constexpr size_t kChunksPerRange = 64;
+// smaller chunks cost more to schedule than to run
+inline constexpr size_t kMinGrain = 16;
+
+// indices per chunk, automatic if grain is 0
+inline size_t GetGrain(size_t count, size_t grain = 0) {
+  if (grain) return grain;
+  return std::max(kMinGrain, (count + kChunksPerRange - 1) / kChunksPerRange);
+}
+
+// fn(begin, end) for every chunk of [0, count)
+// a single chunk (small range) runs inline
+// the helpers inherit the caller's priority, kFrame for the per-frame loops
+template <typename Fn>
+void ParallelFor(size_t count, Fn &&fn, size_t grain = 0,
+                 Priority::Enum priority = GetPriority()) {
+  if (count == 0) return;
+  grain = GetGrain(count, grain);
+  const size_t chunks = (count + grain - 1) / grain;
+  if (chunks == 1) {
+    fn(size_t{0}, count);
+    return;
+  }
+
+  RunChunks(chunks, [&fn, grain, count](size_t chunk) {
+    size_t begin = chunk * grain;
+    fn(begin, std::min(begin + grain, count));
+  }, priority);
+}
+
+// chunk_fn(begin, end) -> T, combine(T, T) -> T
+// partial results are combined in the chunk order (floats are deterministic)
+template <typename T, typename ChunkFn, typename CombineFn>
+T ParallelReduce(size_t count, T identity, ChunkFn &&chunk_fn,
+                 CombineFn &&combine, size_t grain = 0,
+                 Priority::Enum priority = GetPriority()) {
+  if (count == 0) return identity;
+  grain = GetGrain(count, grain);
+  const size_t chunks = (count + grain - 1) / grain;
+  if (chunks == 1) {
+    return combine(identity, chunk_fn(size_t{0}, count));
+  }
+
+  MiVector<T> partial(chunks, identity);
+  RunChunks(chunks, [&partial, &chunk_fn, grain, count](size_t chunk) {
+    size_t begin = chunk * grain;
+    partial[chunk] = chunk_fn(begin, std::min(begin + grain, count));
+  }, priority);
+
+  T result = identity;
+  for (const auto &value : partial) {
+    result = combine(result, value);
+  }
+  return result;
+}
+
+}  // namespace task
+
+}  // namespace app
@@ -93,10 +93,19 @@ ini::Description GetIniDescription() {
       {"Display", "bVSync", &glfw.vsync},
       {"Debug", "bShowDebug", &opengl.show_debug},
       {"Display", "bResizeable", &opengl.resizeable},
+      {"CPU", "bPinWorkers", &cpu.pin_workers},
+      {"CPU", "bTraceLoading", &cpu.trace_loading},
+      {"CPU", "bModelCache", &cpu.model_cache},
+      {"CPU", "bTextureCache", &cpu.texture_cache},
+      {"CPU", "bCompactVertices", &cpu.compact_vertices},
+      {"CPU", "bReportLoading", &cpu.report_loading},
+      {"CPU", "bSaveMetrics", &cpu.save_metrics},
   };
   desc.ints = {
       {"Display", "iWindowMode", &opengl.window_mode.current, 0, 1},
       {"Display", "iCurrentResolution", &opengl.resolution.current, 0, 7},
+      {"CPU", "iTextureCompression", &cpu.texture_compression, 0, 2},
+      {"CPU", "iMetricsInterval", &cpu.metrics_interval, 1, 3600},
   };
 
   return desc;
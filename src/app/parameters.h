@@ -94,8 +94,36 @@ struct Gpu {
 };
 
 struct Cpu {
+  // logical processors (SMT threads)
   unsigned int threads_total{1};
+  unsigned int physical_cores{1};
+  unsigned int l3_groups{1};
   unsigned int task_threads{1};
+  // workers with OpenGL context, the first gl_threads of task_threads
+  unsigned int gl_threads{1};
+  // main thread tasks per frame, the rest waits for the next frame
+  float main_thread_budget_ms{2.0f};
+  // workers (and the main thread) stay on their cores, see app/cpu_topology.h
+  bool pin_workers{false};
+  // Chrome trace of the loading, see utils/profiling.h
+  bool trace_loading{false};
+  // cooked models skip Assimp on the warm starts, see assets/model_cache.h
+  bool model_cache{true};
+  // decoded textures with the mip chain, see assets/texture_cache.h
+  bool texture_cache{true};
+  // 0 - none, 1 - fast (BC1/BC3), 2 - high (BC7), BC4/BC5 for the masks and
+  // the normals, see assets/texture_cache.h
+  int texture_compression{1};
+  // static meshes: octahedral normals and tangents, half float tex coords
+  // (24 bytes per vertex instead of 56), skinned meshes: int16 bones and
+  // unorm8 weights (68 instead of 88), see assets/vertex_format.h
+  bool compact_vertices{true};
+  // per asset JSON breakdown of the loading, see assets/loading_report.h
+  bool report_loading{false};
+  // time series of utils/metrics.h, saved on exit
+  bool save_metrics{false};
+  // frames per sample, 60 covers ~68 minutes at 60 fps
+  int metrics_interval{1};
 };
 
 }  // namespace types
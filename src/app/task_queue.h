@@ -0,0 +1,259 @@
+#pragma once
+
+// global
+#include <atomic>
+#include <cstdint>
+#include <memory>
+// local
+#include "mi_types.h"
+
+namespace app {
+
+// keep the producer and consumer counters on separate cache lines
+inline constexpr size_t kCacheLine = 64;
+
+// Chase-Lev work-stealing deque
+// "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al. 2013
+// the owner pushes and pops at the bottom (LIFO, hot cache)
+// thieves steal at the top (FIFO, the oldest and usually the biggest work)
+// T is a pointer or another trivially copyable handler
+template <typename T>
+class WorkStealingDeque {
+ public:
+  WorkStealingDeque(int64_t capacity = 1024)
+      : array_(new Array(capacity)) {}
+  ~WorkStealingDeque() { delete array_.load(std::memory_order_relaxed); }
+  // atomics (non-copyable, non-movable)
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+ public:
+  // owner only
+  void Push(T item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array *a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      a = Grow(a, b, t);
+    }
+    a->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // owner only
+  bool Pop(T &item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array *a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    item = a->Get(b);
+    if (t == b) {
+      // the last item, race against thieves
+      bool won = top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  // any thread, false if empty or lost the race
+  bool Steal(T &item) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return false;
+
+    Array *a = array_.load(std::memory_order_acquire);
+    item = a->Get(t);
+    return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed);
+  }
+
+  // approximation, other threads can change it at any moment
+  int64_t Size() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return (b > t) ? (b - t) : 0;
+  }
+
+ private:
+  // circular buffer, capacity is power of two
+  struct Array {
+    Array(int64_t c)
+        : capacity(c), mask(c - 1), data(new std::atomic<T>[c]) {}
+    int64_t capacity;
+    int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> data;
+
+    // release/acquire on the slot too, free on x86 and visible to TSan
+    // (it doesn't model the standalone fences)
+    void Put(int64_t i, T item) {
+      data[i & mask].store(item, std::memory_order_release);
+    }
+    T Get(int64_t i) const {
+      return data[i & mask].load(std::memory_order_acquire);
+    }
+  };
+
+  alignas(kCacheLine) std::atomic<int64_t> top_{0};
+  alignas(kCacheLine) std::atomic<int64_t> bottom_{0};
+  alignas(kCacheLine) std::atomic<Array *> array_;
+  // thieves can still read the old array, release it with the deque
+  MiVector<std::unique_ptr<Array>> retired_;
+
+  Array *Grow(Array *a, int64_t b, int64_t t) {
+    Array *grown = new Array(a->capacity * 2);
+    for (int64_t i = t; i < b; ++i) {
+      grown->Put(i, a->Get(i));
+    }
+    retired_.emplace_back(a);
+    array_.store(grown, std::memory_order_release);
+    return grown;
+  }
+};
+
+// bounded multi-producer multi-consumer queue (Dmitry Vyukov)
+// every cell has a sequence number, producers and consumers
+// claim a cell by CAS on their own counter, no locks
+template <typename T>
+class MpmcQueue {
+ public:
+  // capacity is power of two
+  MpmcQueue(size_t capacity = 4096)
+      : mask_(capacity - 1), cells_(new Cell[capacity]) {
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  // atomics (non-copyable, non-movable)
+  MpmcQueue(const MpmcQueue &) = delete;
+  MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+ public:
+  // false if full
+  bool TryPush(T item) {
+    Cell *cell;
+    size_t pos = enqueue_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = item;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // false if empty
+  bool TryPop(T &item) {
+    Cell *cell;
+    size_t pos = dequeue_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_.load(std::memory_order_relaxed);
+      }
+    }
+    item = cell->data;
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(kCacheLine) std::atomic<size_t> enqueue_{0};
+  alignas(kCacheLine) std::atomic<size_t> dequeue_{0};
+};
+
+// unbounded multi-producer single-consumer queue (Dmitry Vyukov)
+// producers exchange the head and link the previous node,
+// the consumer owns the tail, no locks and no CAS loops
+// T is default constructible and movable
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() {
+    Node *stub = new Node();
+    head_.store(stub, std::memory_order_relaxed);
+    tail_ = stub;
+  }
+  ~MpscQueue() {
+    while (tail_) {
+      Node *next = tail_->next.load(std::memory_order_relaxed);
+      delete tail_;
+      tail_ = next;
+    }
+  }
+  // atomics (non-copyable, non-movable)
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+ public:
+  // any thread
+  void Push(T item) {
+    Node *node = new Node();
+    node->value = std::move(item);
+    Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // consumer only, false if empty or the producer hasn't linked the node yet
+  bool TryPop(T &item) {
+    Node *tail = tail_;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) return false;
+    // the popped node becomes the new stub
+    item = std::move(next->value);
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Node {
+    T value{};
+    std::atomic<Node *> next{nullptr};
+  };
+
+  alignas(kCacheLine) std::atomic<Node *> head_;
+  alignas(kCacheLine) Node *tail_;
+};
+
+}  // namespace app
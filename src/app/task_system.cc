@@ -1,40 +1,154 @@
 #include "task_system.h"
 
 // windows
+#if defined(_WIN32)
 // <GLFW/glfw3native.h> conflicts with glm templates, bug
 #define _AMD64_
 #include <errhandlingapi.h>
 #include <windef.h>
 #include <wingdi.h>
+#endif
 // deps
 #include <spdlog/spdlog.h>
 // global
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <queue>
 #include <thread>
 // local
+#include "app/cpu_topology.h"
 #include "app/parameters.h"
+#include "app/task_queue.h"
 #include "mi_types.h"
-
-template <typename T>
-using MiQueue = std::queue<T, std::deque<T, mi_stl_allocator<T>>>;
+#include "utils/profiling.h"
 
 namespace app {
 
 namespace {
 
+using task::Deadline;
+using task::Priority;
+
+// heap allocated, the queues move pointers only
+struct Task {
+  std::function<void(int)> fn;
+  Priority::Enum priority;
+};
+
+// the external threads (main, loading) push to the shared queues,
+// the workers push to their own deques and steal from each other
+// one queue per priority class
+struct Worker {
+  std::array<WorkStealingDeque<Task*>, Priority::kTotal> deques;
+  unsigned int pops{0};
+  // the owner writes, any thread reads
+  std::atomic<uint64_t> tasks{0};
+  std::atomic<uint64_t> steals{0};
+  std::atomic<int64_t> idle_ns{0};
+  // start of the current idle period, 0 if busy
+  std::atomic<int64_t> idle_since{0};
+  std::atomic<int> processor{-1};
+};
+
+// trace zones
+constexpr const char* kTaskZones[Priority::kTotal]{
+    "Task Frame",
+    "Task Normal",
+    "Task Background",
+};
+
+// the lowest class goes first once per kStarvationLimit pops
+constexpr unsigned int kStarvationLimit = 16;
+
+// earliest deadline first, rare (frame jobs), under mutex
+struct DeadlineTask {
+  Deadline deadline;
+  Task* task;
+  bool operator>(const DeadlineTask& other) const {
+    return deadline > other.deadline;
+  }
+};
+using DeadlineQueue =
+    std::priority_queue<DeadlineTask, MiVector<DeadlineTask>,
+                        std::greater<DeadlineTask>>;
+
+// too many OpenGL contexts and the engine jobs don't scale further
+constexpr unsigned int kMaxWorkers = 8;
+// full shared queue applies backpressure to the external producers
+constexpr size_t kSharedQueueCapacity = 16 * 1024;
+// GL-bound tasks are coarse (uploads), never stolen by CPU-only workers
+constexpr size_t kGlQueueCapacity = 1024;
+
 MiVector<std::thread> gWorkers;
-std::mutex gMutex;
-MiQueue<std::function<void(unsigned int)>> gTasks;
+MiVector<std::unique_ptr<Worker>> gQueues;
+std::array<std::unique_ptr<MpmcQueue<Task*>>, Priority::kTotal> gShared;
+std::unique_ptr<MpmcQueue<Task*>> gGlShared;
+prof::Mutex gDeadlineMutex{"task::Deadlines"};
+DeadlineQueue gDeadlines;
+std::atomic<int> gDeadlinesQueued = 0;
+std::atomic<int> gDeadlineMisses = 0;
+// workers [0, gGlThreads) have OpenGL contexts, 0 if headless
+unsigned int gGlThreads = 0;
+// protects WGL calls only
+prof::Mutex gMutex{"task::WGL"};
+std::atomic<int> gTasksQueued = 0;
 std::atomic<int> gTasksTotal = 0;
 std::atomic<bool> gRunning = true;
 std::atomic<bool> gPaused = false;
-int gSleepDurationMs = 500;
+// idle workers spin for a while, then park until a task is pushed
+// ~1-2 us of spinning hides the futex round trip for bursts of tasks
+constexpr int kSpinCount = 256;
+// parked workers wait for the epoch change
+std::atomic<uint32_t> gWakeEpoch = 0;
+std::atomic<int> gSleepers = 0;
+// WaitForTasks() waits for the epoch change (all done or paused)
+std::atomic<uint32_t> gDoneEpoch = 0;
+// per-worker stats are counted from this moment
+std::atomic<int64_t> gStatsStart = 0;
+// -1 for non-worker threads
+thread_local int tWorkerIndex = -1;
+// priority of the running task, inherited by the subtasks
+thread_local Priority::Enum tPriority = Priority::kNormal;
 // OpenGL threads
 void* gDeviceContext;
 MiVector<void*> gRendergingContextWorkers;
 
+void CpuRelax() {
+#if defined(_M_X64) || defined(__x86_64__)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void BeginIdle(Worker& worker) {
+  if (worker.idle_since.load(std::memory_order_relaxed) == 0) {
+    worker.idle_since.store(NowNs(), std::memory_order_relaxed);
+  }
+}
+
+void EndIdle(Worker& worker) {
+  int64_t since = worker.idle_since.load(std::memory_order_relaxed);
+  if (since == 0) return;
+  // the stats could be reset in the meantime
+  since = std::max(since, gStatsStart.load(std::memory_order_relaxed));
+  worker.idle_ns.fetch_add(NowNs() - since, std::memory_order_relaxed);
+  worker.idle_since.store(0, std::memory_order_relaxed);
+}
+
+#if defined(_WIN32)
 // private part
 void GetContextHandlersWGL() {
   // query the already created context
@@ -42,8 +156,8 @@ void GetContextHandlersWGL() {
   HGLRC rendering_context_main = wglGetCurrentContext();
   // create the new context for a OpenGL thread
   MiVector<HGLRC> rendering_context_workers;
-  rendering_context_workers.reserve(app::cpu.task_threads);
-  for (unsigned int t = 0; t < app::cpu.task_threads; ++t) {
+  rendering_context_workers.reserve(gGlThreads);
+  for (unsigned int t = 0; t < gGlThreads; ++t) {
     rendering_context_workers.push_back(wglCreateContext(device_context));
   }
   // share OpenGL objects with main context
@@ -82,43 +196,154 @@ void DeleteContextWGL(unsigned int tid) {
   wglMakeCurrent(nullptr, nullptr);
   wglDeleteContext(static_cast<HGLRC>(gRendergingContextWorkers[tid]));
 }
+#else
+// no WGL, only the headless workers
+void GetContextHandlersWGL() {}
+void MakeCurrentWGL(unsigned int tid) {}
+void DeleteContextWGL(unsigned int tid) {}
+#endif
+
+bool PopDeadline(Task*& task) {
+  if (gDeadlinesQueued.load(std::memory_order_relaxed) == 0) return false;
+
+  std::scoped_lock lock(gDeadlineMutex);
+  if (gDeadlines.empty()) return false;
+  auto [deadline, ptr] = gDeadlines.top();
+  gDeadlines.pop();
+  --gDeadlinesQueued;
+
+  if (Deadline::clock::now() > deadline) {
+    ++gDeadlineMisses;
+  }
+  task = ptr;
+  return true;
+}
 
-bool PopTask(std::function<void(int)>& task) {
-  std::scoped_lock lock(gMutex);
-  if (gTasks.empty()) return false;
+bool PopTask(unsigned int tid, Priority::Enum priority, Task*& task) {
+  // own deque first (LIFO), hot cache
+  if (gQueues[tid]->deques[priority].Pop(task)) return true;
+  if (gShared[priority]->TryPop(task)) return true;
+  // steal the oldest task, start from the neighbour to spread the victims
+  const auto count = static_cast<unsigned int>(gQueues.size());
+  for (unsigned int i = 1; i < count; ++i) {
+    unsigned int victim = (tid + i) % count;
+    if (gQueues[victim]->deques[priority].Steal(task)) {
+      gQueues[tid]->steals.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PopTask(unsigned int tid, Task*& task) {
+  if (PopDeadline(task)) return true;
+
+  // starvation protection, reverse order from time to time
+  bool reverse = (++gQueues[tid]->pops % kStarvationLimit) == 0;
+  for (int i = 0; i < Priority::kTotal; ++i) {
+    auto priority =
+        static_cast<Priority::Enum>(reverse ? Priority::kTotal - 1 - i : i);
+    if (PopTask(tid, priority, task)) return true;
+    // GL uploads after the frame jobs
+    if (priority == Priority::kFrame && tid < gGlThreads &&
+        gGlShared->TryPop(task)) {
+      return true;
+    }
+  }
+  return false;
+}
 
-  task = std::move(gTasks.front());
-  gTasks.pop();
+void WakeWaiting() {
+  gDoneEpoch.fetch_add(1, std::memory_order_release);
+  gDoneEpoch.notify_all();
+}
+
+void Execute(unsigned int tid, Task* task) {
+  --gTasksQueued;
+  gQueues[tid]->tasks.fetch_add(1, std::memory_order_relaxed);
+  // restored for the nested calls (RunChunks helpers)
+  auto parent = tPriority;
+  tPriority = task->priority;
+  {
+    prof::Zone zone(kTaskZones[task->priority]);
+    task->fn(tid);
+  }
+  tPriority = parent;
+  delete task;
+  if (--gTasksTotal == 0) {
+    WakeWaiting();
+  }
+}
+
+bool TryExecute(unsigned int tid) {
+  Task* task = nullptr;
+  if (gPaused || !PopTask(tid, task)) return false;
+  EndIdle(*gQueues[tid]);
+  Execute(tid, task);
   return true;
 }
 
-void SleepOrYield() {
-  if (gSleepDurationMs) {
-    std::this_thread::sleep_for(std::chrono::microseconds(gSleepDurationMs));
+void WakeWorkers(bool all) {
+  // pairs with the fence in Park(), either the pusher sees the sleeper
+  // or the sleeper sees the task (no lost wake-ups)
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (gSleepers.load(std::memory_order_relaxed) == 0) return;
+  gWakeEpoch.fetch_add(1, std::memory_order_release);
+  if (all) {
+    gWakeEpoch.notify_all();
   } else {
-    std::this_thread::yield();
+    gWakeEpoch.notify_one();
   }
 }
 
+void Park(unsigned int tid) {
+  uint32_t epoch = gWakeEpoch.load(std::memory_order_acquire);
+  gSleepers.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // the last check after announcing the sleep
+  if (!gRunning || TryExecute(tid)) {
+    gSleepers.fetch_sub(1, std::memory_order_relaxed);
+    return;
+  }
+  gWakeEpoch.wait(epoch, std::memory_order_acquire);
+  gSleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
 // std::this_thread::get_id() uses
 // Windows TEB/TIB that is stored in FS CPU register
 // as "current thread ID" at FS:[0x24] which is fast but
 // sync access to [thread_id, index] container is slow
 // better to pass the index as argument directly
 void ExecuteTask(unsigned int tid) {
-  MakeCurrentWGL(tid);
+  tWorkerIndex = static_cast<int>(tid);
+  prof::SetThreadName(fmt::format("Worker {}", tid));
+  auto& worker = *gQueues[tid];
+  const int processor = worker.processor;
+  if (processor >= 0 && !topology::PinThread(processor)) {
+    spdlog::warn("{}: Failed to pin worker {} to processor {}", __FUNCTION__,
+                 tid, processor);
+    worker.processor = -1;
+  }
+  if (tid < gGlThreads) {
+    MakeCurrentWGL(tid);
+  }
 
+  int idle = 0;
   while (gRunning) {
-    std::function<void(int)> task;
-    if (!gPaused && PopTask(task)) {
-      task(tid);
-      --gTasksTotal;
+    if (TryExecute(tid)) {
+      idle = 0;
+    } else if (idle < kSpinCount) {
+      if (idle++ == 0) BeginIdle(worker);
+      CpuRelax();
     } else {
-      SleepOrYield();
+      Park(tid);
+      idle = 0;
     }
   }
 
-  DeleteContextWGL(tid);
+  if (tid < gGlThreads) {
+    DeleteContextWGL(tid);
+  }
 }
 
 }  // namespace
@@ -126,19 +351,63 @@ void ExecuteTask(unsigned int tid) {
 namespace init {
 
 void GetCpuCores() {
-  app::set::cpu.threads_total = std::thread::hardware_concurrency();
-  if (app::cpu.threads_total > 1) {
-    // limit by 8 threads (too many OpenGL context)
-    app::set::cpu.task_threads = max(8U, app::cpu.threads_total);
-  }
+  const auto& topo = topology::Get();
+  app::set::cpu.threads_total =
+      static_cast<unsigned int>(topo.processors.size());
+  app::set::cpu.physical_cores = topo.physical_cores;
+  app::set::cpu.l3_groups = topo.l3_groups;
+  // one worker per physical core, the main thread keeps its own
+  // (SMT siblings share the core, no gain for the engine jobs)
+  app::set::cpu.task_threads =
+      std::clamp(topo.physical_cores - 1, 1U, kMaxWorkers);
+  spdlog::info("{}: {} logical, {} physical, {} L3, {} workers", __FUNCTION__,
+               app::cpu.threads_total, app::cpu.physical_cores,
+               app::cpu.l3_groups, app::cpu.task_threads);
 }
 
 void CreateWorkers() {
   GetCpuCores();
-  GetContextHandlersWGL();
+  CreateWorkers(app::cpu.task_threads, app::cpu.task_threads);
+}
+
+void CreateWorkers(unsigned int task_threads, unsigned int gl_threads) {
+  app::set::cpu.task_threads = task_threads;
+  gGlThreads = std::min(gl_threads, task_threads);
+#if !defined(_WIN32)
+  if (gGlThreads) {
+    spdlog::warn("{}: OpenGL workers need WGL, headless only", __FUNCTION__);
+    gGlThreads = 0;
+  }
+#endif
+  app::set::cpu.gl_threads = gGlThreads;
+  if (gGlThreads) {
+    GetContextHandlersWGL();
+  }
+
+  // all queues exist before the first thief starts
+  for (auto& shared : gShared) {
+    shared = std::make_unique<MpmcQueue<Task*>>(kSharedQueueCapacity);
+  }
+  gGlShared = std::make_unique<MpmcQueue<Task*>>(kGlQueueCapacity);
+  gQueues.reserve(task_threads);
+  for (unsigned int tid = 0; tid < task_threads; ++tid) {
+    gQueues.push_back(std::make_unique<Worker>());
+  }
+  if (app::cpu.pin_workers) {
+    // neighbour workers share L3, the steals stay in the cache
+    auto placement = topology::GetPlacement(task_threads);
+    for (unsigned int tid = 0; tid < task_threads; ++tid) {
+      gQueues[tid]->processor = static_cast<int>(placement[tid]);
+    }
+    if (!topology::PinThread(topology::GetMainProcessor())) {
+      spdlog::warn("{}: Failed to pin the main thread", __FUNCTION__);
+    }
+  }
+  gStatsStart = NowNs();
 
-  gWorkers.reserve(app::cpu.task_threads);
-  for (unsigned int tid = 0; tid < app::cpu.task_threads; ++tid) {
+  gRunning = true;
+  gWorkers.reserve(task_threads);
+  for (unsigned int tid = 0; tid < task_threads; ++tid) {
     gWorkers.emplace_back(ExecuteTask, tid);
   }
 }
@@ -146,46 +415,306 @@ void CreateWorkers() {
 void DestroyWorkers() {
   task::WaitForTasks();
   gRunning = false;
+  WakeWorkers(true);
 
   for (auto& worker : gWorkers) {
     worker.join();
   }
+  MiVector<task::WorkerStats> stats;
+  task::GetWorkerStats(stats);
+  for (size_t tid = 0; tid < stats.size(); ++tid) {
+    const auto& worker = stats[tid];
+    float total_ms = worker.busy_ms + worker.idle_ms;
+    spdlog::info("Worker {} (cpu {}): {} tasks, {} steals, busy {:.1f}%", tid,
+                 worker.processor, worker.tasks, worker.steals,
+                 total_ms > 0.0f ? 100.0f * worker.busy_ms / total_ms : 0.0f);
+  }
+  gWorkers.clear();
+  gQueues.clear();
+  for (auto& shared : gShared) {
+    shared.reset();
+  }
+  gGlShared.reset();
+  gRendergingContextWorkers.clear();
+  gGlThreads = 0;
 }
 
 }  // namespace init
 
 namespace task {
 
-void Pause() { gPaused = true; }
-
-void Unpause() { gPaused = false; }
+void Pause() {
+  gPaused = true;
+  // WaitForTasks() waits for the running tasks only
+  WakeWaiting();
+}
 
-int GetTasksQueued() {
-  std::scoped_lock lock(gMutex);
-  return static_cast<int>(gTasks.size());
+void Unpause() {
+  gPaused = false;
+  WakeWorkers(true);
 }
 
-int GetTasksRunning() { return gTasksTotal - GetTasksQueued(); }
+int GetTasksQueued() { return gTasksQueued; }
+
+int GetTasksRunning() { return gTasksTotal - gTasksQueued; }
 
 int GetTasksTotal() { return gTasksTotal; }
 
+int GetDeadlineMisses() { return gDeadlineMisses; }
+
+Priority::Enum GetPriority() { return tPriority; }
+
+void GetWorkerStats(MiVector<WorkerStats>& stats) {
+  const int64_t now = NowNs();
+  const int64_t start = gStatsStart.load(std::memory_order_relaxed);
+  const int64_t total_ns = now - start;
+  stats.resize(gQueues.size());
+  for (size_t tid = 0; tid < gQueues.size(); ++tid) {
+    const auto& worker = *gQueues[tid];
+    int64_t idle_ns = worker.idle_ns.load(std::memory_order_relaxed);
+    // the current idle period isn't counted yet
+    int64_t since = worker.idle_since.load(std::memory_order_relaxed);
+    if (since != 0) {
+      idle_ns += now - std::max(since, start);
+    }
+    idle_ns = std::clamp<int64_t>(idle_ns, 0, total_ns);
+
+    auto& out = stats[tid];
+    out.tasks = worker.tasks.load(std::memory_order_relaxed);
+    out.steals = worker.steals.load(std::memory_order_relaxed);
+    out.idle_ms = static_cast<float>(idle_ns) * 1e-6f;
+    out.busy_ms = static_cast<float>(total_ns - idle_ns) * 1e-6f;
+    out.processor = worker.processor;
+  }
+}
+
+uint64_t GetTasksExecuted() {
+  uint64_t tasks = 0;
+  for (const auto& worker : gQueues) {
+    tasks += worker->tasks.load(std::memory_order_relaxed);
+  }
+  return tasks;
+}
+
+void ResetWorkerStats() {
+  gStatsStart = NowNs();
+  for (auto& worker : gQueues) {
+    worker->tasks = 0;
+    worker->steals = 0;
+    worker->idle_ns = 0;
+  }
+}
+
 void PushTask(std::function<void(int)> task) {
+  // tPriority is kNormal outside of workers
+  PushTask(std::move(task), tPriority);
+}
+
+void PushTask(std::function<void(int)> task, Priority::Enum priority) {
   gTasksTotal++;
+  gTasksQueued++;
+  auto* ptr = new Task{std::move(task), priority};
+  // a worker spawns the subtasks into its own deque
+  if (tWorkerIndex >= 0) {
+    gQueues[tWorkerIndex]->deques[priority].Push(ptr);
+  } else {
+    while (!gShared[priority]->TryPush(ptr)) {
+      std::this_thread::yield();
+    }
+  }
+  WakeWorkers(false);
+}
+
+void PushTask(std::function<void(int)> task, Deadline deadline) {
+  gTasksTotal++;
+  gTasksQueued++;
+  // the subtasks of a deadline task are frame-critical
+  auto* ptr = new Task{std::move(task), Priority::kFrame};
   {
-    std::scoped_lock lock(gMutex);
-    gTasks.push(std::move(task));
+    std::scoped_lock lock(gDeadlineMutex);
+    gDeadlines.push(DeadlineTask{deadline, ptr});
+    ++gDeadlinesQueued;
+  }
+  WakeWorkers(false);
+}
+
+void PushTask(Group& group, std::function<void(int)> task) {
+  PushTask(group, std::move(task), tPriority);
+}
+
+void PushTask(Group& group, std::function<void(int)> task,
+              Priority::Enum priority) {
+  group.Add();
+  PushTask(
+      [&group, task = std::move(task)](int tid) {
+        task(tid);
+        group.Finish();
+      },
+      priority);
+}
+
+int GetWorkerIndex() { return tWorkerIndex; }
+
+unsigned int GetWorkerCount() {
+  return static_cast<unsigned int>(gQueues.size());
+}
+
+void RunChunks(size_t chunks, const std::function<void(size_t)>& fn,
+               Priority::Enum priority) {
+  // inline if nothing to split or nobody to help
+  if (chunks <= 1 || gQueues.empty()) {
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+      fn(chunk);
+    }
+    return;
+  }
+
+  // the late helpers can start after return, they keep the counters
+  // alive and touch fn only if they claimed a chunk
+  struct Chunks {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    size_t total{0};
+    const std::function<void(size_t)>* fn{nullptr};
+
+    void Run() {
+      size_t chunk;
+      while ((chunk = next.fetch_add(1)) < total) {
+        (*fn)(chunk);
+        if (done.fetch_add(1) + 1 == total) {
+          done.notify_all();
+        }
+      }
+    }
+  };
+  auto shared = std::make_shared<Chunks>();
+  shared->total = chunks;
+  shared->fn = &fn;
+
+  size_t helpers = std::min(chunks - 1, gQueues.size());
+  for (size_t i = 0; i < helpers; ++i) {
+    PushTask([shared](int) { shared->Run(); }, priority);
+  }
+  shared->Run();
+
+  // the rest is already running on the helpers
+  size_t done = shared->done.load();
+  while (done != chunks) {
+    shared->done.wait(done);
+    done = shared->done.load();
+  }
+}
+
+void PushGlTask(std::function<void(int)> task) {
+  if (gGlThreads == 0) {
+    // headless: the awaiting coroutines must resume, GL calls are invalid
+    static std::once_flag warned;
+    std::call_once(warned, [] {
+      spdlog::warn("PushGlTask: No OpenGL workers (headless), CPU pool");
+    });
+    PushTask(std::move(task), tPriority);
+    return;
+  }
+  gTasksTotal++;
+  gTasksQueued++;
+  auto* ptr = new Task{std::move(task), tPriority};
+  Task* queued = nullptr;
+  while (!gGlShared->TryPush(ptr)) {
+    // the GL workers are the only consumers, help instead of waiting
+    if (IsGlWorker() && gGlShared->TryPop(queued)) {
+      Execute(static_cast<unsigned int>(tWorkerIndex), queued);
+    } else {
+      std::this_thread::yield();
+    }
   }
+  // a single wake-up can pick a CPU-only worker
+  WakeWorkers(true);
+}
+
+bool IsGlWorker() {
+  if (tWorkerIndex < 0) return false;
+  return static_cast<unsigned int>(tWorkerIndex) < gGlThreads;
 }
 
 void WaitForTasks() {
   while (true) {
     if (!gPaused) {
+      // the last task wakes up the waiting thread
+      uint32_t epoch = gDoneEpoch.load(std::memory_order_acquire);
+      if (gPaused) continue;
       if (gTasksTotal == 0) break;
+      gDoneEpoch.wait(epoch, std::memory_order_acquire);
     } else {
       if (GetTasksRunning() == 0) break;
+      std::this_thread::yield();
+    }
+  }
+}
+
+void Group::Add(int count) { tasks_total_ += count; }
+
+void Group::Finish() {
+  if (--tasks_total_ == 0) {
+    tasks_total_.notify_all();
+  }
+}
+
+int Group::GetTasksTotal() const { return tasks_total_; }
+
+bool Group::IsDone() const { return tasks_total_ == 0; }
+
+void Group::Wait() const {
+  // futex-like, the last task wakes up the waiting thread
+  int total = tasks_total_.load();
+  while (total != 0) {
+    tasks_total_.wait(total);
+    total = tasks_total_.load();
+  }
+}
+
+Graph::Node Graph::Emplace(std::function<void(int)> task) {
+  auto& node = nodes_.emplace_back(std::make_unique<NodeData>());
+  node->task = std::move(task);
+  return nodes_.size() - 1;
+}
+
+void Graph::Precede(Node first, Node then) {
+  nodes_[first]->successors.push_back(then);
+  ++nodes_[then]->dependencies;
+}
+
+void Graph::Run() {
+  for (auto& node : nodes_) {
+    node->pending = node->dependencies;
+  }
+
+  bool has_roots = false;
+  for (Node node = 0; node < nodes_.size(); ++node) {
+    if (nodes_[node]->dependencies == 0) {
+      Schedule(node);
+      has_roots = true;
     }
-    SleepOrYield();
   }
+  if (nodes_.size() && !has_roots) {
+    spdlog::error("{}: Graph has a cycle, no root nodes", __FUNCTION__);
+  }
+}
+
+bool Graph::IsDone() const { return group_.IsDone(); }
+
+void Graph::Wait() const { group_.Wait(); }
+
+void Graph::Schedule(Node node) {
+  // the successors are counted by the group before this task is finished
+  PushTask(group_, [this, node](int tid) {
+    auto& data = *nodes_[node];
+    data.task(tid);
+    for (Node next : data.successors) {
+      if (--nodes_[next]->pending == 0) {
+        Schedule(next);
+      }
+    }
+  });
 }
 
 }  // namespace task
@@ -1,26 +1,138 @@
 #pragma once
 
 // global
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
+// local
+#include "mi_types.h"
 
 namespace app {
 
 namespace init {
 
+// one worker per physical core (except the main one), all with OpenGL
+// contexts, pinned if app::cpu.pin_workers
 void CreateWorkers();
+// the first gl_threads workers get OpenGL contexts (WGL)
+// gl_threads == 0 is headless: no window, CPU-only tasks (tools, benchmarks)
+void CreateWorkers(unsigned int task_threads, unsigned int gl_threads);
 void DestroyWorkers();
 
 }  // namespace init
 
 namespace task {
 
+// frame-critical jobs go first, background (streaming, I/O) last
+// every worker gives the lower classes a chance from time to time
+struct Priority {
+  enum Enum : uint8_t { kFrame, kNormal, kBackground, kTotal };
+};
+
+// tasks with deadline run earliest first, before any priority class
+using Deadline = std::chrono::steady_clock::time_point;
+
+// since CreateWorkers() or ResetWorkerStats()
+struct WorkerStats {
+  uint64_t tasks{0};
+  // taken from the other workers
+  uint64_t steals{0};
+  float busy_ms{0.0f};
+  // spinning and parked
+  float idle_ms{0.0f};
+  // logical processor, -1 if not pinned
+  int processor{-1};
+};
+
+// counter of the unfinished tasks, independent of the global one
+// don't Wait() inside a task (blocks the worker), use Graph instead
+class Group {
+ public:
+  Group() = default;
+  // atomic counter (non-copyable, non-movable)
+  Group(const Group &) = delete;
+  Group &operator=(const Group &) = delete;
+
+ public:
+  // manual counting for the work that outlives a single task (coroutines)
+  void Add(int count = 1);
+  void Finish();
+  int GetTasksTotal() const;
+  bool IsDone() const;
+  void Wait() const;
+
+ private:
+  std::atomic<int> tasks_total_{0};
+};
+
+// small DAG executor, a node starts when all its predecessors are finished
+// the continuations are pushed by the worker that finished the last one
+class Graph {
+ public:
+  using Node = size_t;
+
+  Graph() = default;
+  // tasks capture the graph (non-copyable, non-movable)
+  Graph(const Graph &) = delete;
+  Graph &operator=(const Graph &) = delete;
+
+ public:
+  Node Emplace(std::function<void(int)> task);
+  // 'then' starts after 'first' is finished
+  void Precede(Node first, Node then);
+  // can be run again after Wait()
+  void Run();
+  bool IsDone() const;
+  void Wait() const;
+
+ private:
+  struct NodeData {
+    std::function<void(int)> task;
+    MiVector<Node> successors;
+    int dependencies{0};
+    std::atomic<int> pending{0};
+  };
+  MiVector<std::unique_ptr<NodeData>> nodes_;
+  Group group_;
+
+  void Schedule(Node node);
+};
+
 void Pause();
 void Unpause();
 int GetTasksQueued();
 int GetTasksRunning();
 int GetTasksTotal();
+// tasks started after their deadline
+int GetDeadlineMisses();
+// priority of the running task, kNormal outside of workers
+Priority::Enum GetPriority();
+void GetWorkerStats(MiVector<WorkerStats> &stats);
+void ResetWorkerStats();
+// sum of WorkerStats::tasks
+uint64_t GetTasksExecuted();
+// inherits the priority of the running task, kNormal outside of workers
 void PushTask(std::function<void(int)> task);
+void PushTask(std::function<void(int)> task, Priority::Enum priority);
+void PushTask(std::function<void(int)> task, Deadline deadline);
+void PushTask(Group &group, std::function<void(int)> task);
+void PushTask(Group &group, std::function<void(int)> task,
+              Priority::Enum priority);
+// runs on a worker with OpenGL context only
+// headless pools (no GL workers) run it on the CPU pool, no GL calls there
+void PushGlTask(std::function<void(int)> task);
 void WaitForTasks();
+// -1 for non-worker threads
+int GetWorkerIndex();
+unsigned int GetWorkerCount();
+bool IsGlWorker();
+// fn(chunk) for every chunk in [0, chunks), the calling thread takes part
+// returns when all chunks are finished, see app/parallel.h
+// the helpers run at priority (kFrame for the per-frame loops)
+void RunChunks(size_t chunks, const std::function<void(size_t)> &fn,
+               Priority::Enum priority);
 
 }  // namespace task
 
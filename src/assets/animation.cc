@@ -3,10 +3,26 @@
 // deps
 #include <assimp/scene.h>
 // local
+#include "assets/cooked_blob.h"
 #include "math/assimp_to_glm.h"
 
+namespace {
+
+template <typename T>
+void ReadArray(cooked::Reader& reader, AnimVector<T>& values) {
+  auto view = reader.Array<T>();
+  values.assign(view.begin(), view.end());
+}
+
+template <typename T>
+void WriteArray(cooked::Writer& writer, const AnimVector<T>& values) {
+  writer.Array(std::span<const T>(values));
+}
+
+}  // namespace
+
 Bone::Bone(int id, const aiNodeAnim* channel) noexcept
-    : id_(id), local_transform_(1.0f) {
+    : id_(id) {
   num_positions = channel->mNumPositionKeys;
   positions.reserve(num_positions);
   positions_time.reserve(num_positions);
@@ -35,26 +51,47 @@ Bone::Bone(int id, const aiNodeAnim* channel) noexcept
   }
 };
 
-void Bone::Update(float animation_time) {
+Bone::Bone(cooked::Reader& reader) noexcept : id_(reader.Pod<int>()) {
+  ReadArray(reader, positions);
+  ReadArray(reader, positions_time);
+  ReadArray(reader, rotations);
+  ReadArray(reader, rotations_time);
+  ReadArray(reader, scales);
+  ReadArray(reader, scales_time);
+  num_positions = static_cast<unsigned int>(positions.size());
+  num_rotations = static_cast<unsigned int>(rotations.size());
+  num_scalings = static_cast<unsigned int>(scales.size());
+}
+
+void Bone::Write(cooked::Writer& writer) const {
+  writer.Pod(id_);
+  WriteArray(writer, positions);
+  WriteArray(writer, positions_time);
+  WriteArray(writer, rotations);
+  WriteArray(writer, rotations_time);
+  WriteArray(writer, scales);
+  WriteArray(writer, scales_time);
+}
+
+glm::mat4 Bone::GetLocalTransform(float animation_time) const {
   glm::vec3 translation = InterpolatePosition(animation_time);
   glm::quat rotation = InterpolateRotation(animation_time);
   glm::vec3 scale = InterpolateScaling(animation_time);
 
-  local_transform_ = glm::mat4_cast(rotation);
-  local_transform_[0] = scale.x * local_transform_[0];
-  local_transform_[1] = scale.y * local_transform_[1];
-  local_transform_[2] = scale.z * local_transform_[2];
-  local_transform_[3].x = translation.x;
-  local_transform_[3].y = translation.y;
-  local_transform_[3].z = translation.z;
-  local_transform_[3].w = 1.0f;
+  glm::mat4 local_transform = glm::mat4_cast(rotation);
+  local_transform[0] = scale.x * local_transform[0];
+  local_transform[1] = scale.y * local_transform[1];
+  local_transform[2] = scale.z * local_transform[2];
+  local_transform[3].x = translation.x;
+  local_transform[3].y = translation.y;
+  local_transform[3].z = translation.z;
+  local_transform[3].w = 1.0f;
+  return local_transform;
 }
 
-const glm::mat4& Bone::GetLocalTransform() const { return local_transform_; }
-
 int Bone::GetBoneID() const { return id_; }
 
-const int Bone::GetPositionIndex(float animation_time) {
+const int Bone::GetPositionIndex(float animation_time) const {
   for (unsigned int i = 0; i < num_positions - 1; ++i) {
     if (animation_time < positions_time[i + 1]) {
       return i;
@@ -63,7 +100,7 @@ const int Bone::GetPositionIndex(float animation_time) {
   return 0;
 }
 
-const int Bone::GetRotationIndex(float animation_time) {
+const int Bone::GetRotationIndex(float animation_time) const {
   for (unsigned int i = 0; i < num_rotations - 1; ++i) {
     if (animation_time < rotations_time[i + 1]) {
       return i;
@@ -72,7 +109,7 @@ const int Bone::GetRotationIndex(float animation_time) {
   return 0;
 }
 
-const int Bone::GetScaleIndex(float animation_time) {
+const int Bone::GetScaleIndex(float animation_time) const {
   for (unsigned int i = 0; i < num_scalings - 1; ++i) {
     if (animation_time < scales_time[i + 1]) {
       return i;
@@ -82,7 +119,7 @@ const int Bone::GetScaleIndex(float animation_time) {
 }
 
 float Bone::GetScaleFactor(float last_timestamp, float next_timestamp,
-                           float animation_time) {
+                           float animation_time) const {
   float scale_factor = 0.0f;
   float midway_length = animation_time - last_timestamp;
   float frames_diff = next_timestamp - last_timestamp;
@@ -90,7 +127,7 @@ float Bone::GetScaleFactor(float last_timestamp, float next_timestamp,
   return scale_factor;
 }
 
-glm::vec3 Bone::InterpolatePosition(float animation_time) {
+glm::vec3 Bone::InterpolatePosition(float animation_time) const {
   if (num_positions == 1) return positions[0];
 
   int p0 = GetPositionIndex(animation_time);
@@ -102,7 +139,7 @@ glm::vec3 Bone::InterpolatePosition(float animation_time) {
   return final_position;
 }
 
-glm::quat Bone::InterpolateRotation(float animation_time) {
+glm::quat Bone::InterpolateRotation(float animation_time) const {
   if (num_rotations == 1) {
     glm::quat rotation = glm::normalize(rotations[0]);
     return rotation;
@@ -118,7 +155,7 @@ glm::quat Bone::InterpolateRotation(float animation_time) {
   return final_rotation;
 }
 
-glm::vec3 Bone::InterpolateScaling(float animation_time) {
+glm::vec3 Bone::InterpolateScaling(float animation_time) const {
   if (num_scalings == 1) return scales[0];
 
   int p0 = GetScaleIndex(animation_time);
@@ -142,13 +179,60 @@ Animation::Animation(aiAnimation* animation, aiNode* root_node,
   CreateAnimationBoxes(skeleton);
 }
 
+Animation::Animation(cooked::Reader& reader) noexcept
+    : name_(reader.String()) {
+  ticks_per_second_ = reader.Pod<int>();
+  duration_ = reader.Pod<float>();
+
+  nodes_data_.resize(reader.Count());
+  for (auto& node : nodes_data_) {
+    node.bone_id = reader.Pod<int>();
+    node.transformation = reader.Pod<glm::mat4>();
+    ReadArray(reader, node.children);
+  }
+
+  const uint32_t bone_count = reader.Count();
+  bones_.reserve(bone_count);
+  for (uint32_t i = 0; i < bone_count && reader.IsOk(); ++i) {
+    bones_.emplace_back(reader);
+  }
+
+  boxes_.resize(reader.Count());
+  for (auto& keyframes : boxes_) {
+    ReadArray(reader, keyframes);
+  }
+}
+
+void Animation::Write(cooked::Writer& writer) const {
+  writer.String(name_);
+  writer.Pod(ticks_per_second_);
+  writer.Pod(duration_);
+
+  writer.Pod(static_cast<uint32_t>(nodes_data_.size()));
+  for (const auto& node : nodes_data_) {
+    writer.Pod(node.bone_id);
+    writer.Pod(node.transformation);
+    WriteArray(writer, node.children);
+  }
+
+  writer.Pod(static_cast<uint32_t>(bones_.size()));
+  for (const auto& bone : bones_) {
+    bone.Write(writer);
+  }
+
+  writer.Pod(static_cast<uint32_t>(boxes_.size()));
+  for (const auto& keyframes : boxes_) {
+    WriteArray(writer, keyframes);
+  }
+}
+
 const std::string& Animation::GetName() const { return name_; }
 
 float Animation::GetTicksPerSecond() const { return ticks_per_second_; }
 
 float Animation::GetDuration() const { return duration_; }
 
-const MiVector<Bone>& Animation::GetBones() const { return bones_; }
+const AnimVector<Bone>& Animation::GetBones() const { return bones_; }
 
 GLuint Animation::GetNumOfBones() const {
   return static_cast<GLuint>(bones_.size());
@@ -289,9 +373,7 @@ void Animation::CalculateKeyframeBoxes(const Skeleton& skeleton,
 
     if (bone_id >= 0) {
       // local
-      auto& bone = bones_[bone_id];
-      bone.Update(current_time);
-      node_transform = bone.GetLocalTransform();
+      node_transform = bones_[bone_id].GetLocalTransform(current_time);
       // bone chain
       global_transformation = parent_transform * node_transform;
       // mesh space
@@ -342,8 +424,8 @@ void Animation::CreateAnimationBoxes(const Skeleton& skeleton) noexcept {
 }
 
 void Animation::PlayAnimation(const Skeleton& skeleton, float time,
-                              std::span<glm::mat4> bone_mat) noexcept {
-  MiVector<NodeData*> stack;
+                              std::span<glm::mat4> bone_mat) const noexcept {
+  MiVector<const NodeData*> stack;
   MiVector<glm::mat4> parent;
   stack.push_back(&nodes_data_[0]);
   parent.push_back(glm::mat4(1.0f));
@@ -361,9 +443,7 @@ void Animation::PlayAnimation(const Skeleton& skeleton, float time,
 
     if (bone_id >= 0) {
       // local
-      Bone& bone = bones_[bone_id];
-      bone.Update(time);
-      node_transform = bone.GetLocalTransform();
+      node_transform = bones_[bone_id].GetLocalTransform(time);
       // bone chain
       global_transformation = parent_transform * node_transform;
       // mesh space
@@ -7,11 +7,22 @@
 #include <string>
 // local
 #include "math/collision_types.h"
+#include "mem_info.h"
 #include "mi_types.h"
 // fwd
 struct aiNode;
 struct aiAnimation;
 struct aiNodeAnim;
+namespace cooked {
+class Reader;
+class Writer;
+}  // namespace cooked
+
+// skeletons and keyframes live as long as their models
+template <typename T>
+using AnimVector = mem::TagVector<T, mem::Tag::kAnimation>;
+template <typename K, typename T>
+using AnimUnMap = mem::TagUnMap<K, T, mem::Tag::kAnimation>;
 
 // created in two steps:
 // 1. populated by processing Mesh (extract bones/boxes)
@@ -24,45 +35,47 @@ struct Skeleton {
     bone_box.reserve(total_bones);
   }
   // to read animation's channels, check node hierarchy for bone
-  MiUnMap<std::string, int> bone_map;
+  AnimUnMap<std::string, int> bone_map;
   // bone space to mesh space, already combined
-  MiVector<glm::mat4> bone_to_local;
+  AnimVector<glm::mat4> bone_to_local;
   // bone_id to AABB
-  MiUnMap<int, AABB> bone_box;
+  AnimUnMap<int, AABB> bone_box;
   // bone indices per mesh
-  MiVector<MiVector<int>> bones_per_model;
+  AnimVector<AnimVector<int>> bones_per_model;
 };
 
 class Bone {
  public:
   Bone(int id, const aiNodeAnim* channel) noexcept;
+  // model cache (assets/model_cache.h)
+  explicit Bone(cooked::Reader& reader) noexcept;
+  void Write(cooked::Writer& writer) const;
 
  public:
-  void Update(float animation_time);
-  const glm::mat4& GetLocalTransform() const;
+  // pure, the same bone is played by many objects in parallel
+  glm::mat4 GetLocalTransform(float animation_time) const;
   int GetBoneID() const;
 
  private:
   int id_;
-  MiVector<glm::vec3> positions;
-  MiVector<glm::quat> rotations;
-  MiVector<glm::vec3> scales;
-  MiVector<float> positions_time;
-  MiVector<float> rotations_time;
-  MiVector<float> scales_time;
+  AnimVector<glm::vec3> positions;
+  AnimVector<glm::quat> rotations;
+  AnimVector<glm::vec3> scales;
+  AnimVector<float> positions_time;
+  AnimVector<float> rotations_time;
+  AnimVector<float> scales_time;
   unsigned int num_positions;
   unsigned int num_rotations;
   unsigned int num_scalings;
-  glm::mat4 local_transform_;
-
-  const int GetPositionIndex(float animation_time);
-  const int GetRotationIndex(float animation_time);
-  const int GetScaleIndex(float animation_time);
-  glm::vec3 InterpolatePosition(float animation_time);
-  glm::quat InterpolateRotation(float animation_time);
-  glm::vec3 InterpolateScaling(float animation_time);
+
+  const int GetPositionIndex(float animation_time) const;
+  const int GetRotationIndex(float animation_time) const;
+  const int GetScaleIndex(float animation_time) const;
+  glm::vec3 InterpolatePosition(float animation_time) const;
+  glm::quat InterpolateRotation(float animation_time) const;
+  glm::vec3 InterpolateScaling(float animation_time) const;
   float GetScaleFactor(float last_timestamp, float next_timestamp,
-                       float animation_time);
+                       float animation_time) const;
 };
 
 // flatten data, from list to vector
@@ -72,7 +85,7 @@ struct NodeData {
   // indentation if bone
   glm::mat4 transformation{1.0f};
   // indices inside vector
-  MiVector<int> children;
+  AnimVector<int> children;
 };
 
 // if import Blender .fbx via Assimp
@@ -81,6 +94,9 @@ class Animation {
  public:
   Animation(aiAnimation* animation, aiNode* root_node,
             Skeleton& skeleton) noexcept;
+  // model cache, the keyframe boxes are not recalculated
+  explicit Animation(cooked::Reader& reader) noexcept;
+  void Write(cooked::Writer& writer) const;
 
  public:
   const std::string& GetName() const;
@@ -88,12 +104,13 @@ class Animation {
   float GetTicksPerSecond() const;
   float GetDuration() const;
 
-  const MiVector<Bone>& GetBones() const;
+  const AnimVector<Bone>& GetBones() const;
   GLuint GetNumOfBones() const;
   gpu::AABB GetCurrentBox(GLuint mesh, float time) const;
 
+  // thread-safe, writes to bone_mat only
   void PlayAnimation(const Skeleton& skeleton, float time,
-                     std::span<glm::mat4> bone_mat) noexcept;
+                     std::span<glm::mat4> bone_mat) const noexcept;
 
  private:
   std::string name_;
@@ -101,10 +118,10 @@ class Animation {
   int ticks_per_second_;
   float duration_;
 
-  MiVector<NodeData> nodes_data_;
-  MiVector<Bone> bones_;
+  AnimVector<NodeData> nodes_data_;
+  AnimVector<Bone> bones_;
   // per mesh, keyframe boxes, [mesh][tick]
-  MiVector<MiVector<gpu::AABB>> boxes_;
+  AnimVector<AnimVector<gpu::AABB>> boxes_;
 
   void ReadBonesData(const aiAnimation* animation, Skeleton& skeleton) noexcept;
 
@@ -0,0 +1,654 @@
+#include "block_compression.h"
+
+// global
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+// local
+#include "app/parallel.h"
+#include "utils/profiling.h"
+
+namespace bc {
+
+namespace {
+
+constexpr int kTexels = 16;
+// RGBA of the block, row-major
+using Texels = uint8_t[kTexels][4];
+
+// position between the endpoints of every index
+constexpr float kBc1Weights[4]{0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+constexpr float kBc4Weights[8]{0.0f,        1.0f,        1.0f / 7.0f,
+                               2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f,
+                               5.0f / 7.0f, 6.0f / 7.0f};
+// BC7 4 bit indices, out of 64
+constexpr int kBc7Weights[16]{0,  4,  9,  13, 17, 21, 26, 30,
+                              34, 38, 43, 47, 51, 55, 60, 64};
+
+int Clamp8(long value) { return static_cast<int>(std::clamp(value, 0L, 255L)); }
+
+void LoadTexels(const uint8_t *pixels, int width, int height, size_t pitch,
+                int channels, int block_x, int block_y, Texels &texels) {
+  for (int y = 0; y < 4; ++y) {
+    const int py = std::min(block_y * 4 + y, height - 1);
+    const uint8_t *row = pixels + py * pitch;
+    for (int x = 0; x < 4; ++x) {
+      const int px = std::min(block_x * 4 + x, width - 1);
+      const uint8_t *texel = row + static_cast<size_t>(px) * channels;
+      uint8_t *out = texels[y * 4 + x];
+      for (int c = 0; c < 3; ++c) {
+        out[c] = c < channels ? texel[c] : 0;
+      }
+      out[3] = channels > 3 ? texel[3] : 255;
+    }
+  }
+}
+
+// the extremes of the texels projected on the principal axis of the
+// channels [first, first + count), power iteration of the covariance
+void GetAxisEndpoints(const Texels &texels, int first, int count, float e0[4],
+                      float e1[4]) {
+  float mean[4]{};
+  for (const auto &texel : texels) {
+    for (int c = 0; c < count; ++c) {
+      mean[c] += texel[first + c];
+    }
+  }
+  for (int c = 0; c < count; ++c) {
+    mean[c] /= kTexels;
+  }
+
+  float cov[4][4]{};
+  for (const auto &texel : texels) {
+    for (int a = 0; a < count; ++a) {
+      const float da = texel[first + a] - mean[a];
+      for (int b = 0; b < count; ++b) {
+        cov[a][b] += da * (texel[first + b] - mean[b]);
+      }
+    }
+  }
+
+  // the row of the largest variance is a good start
+  int start = 0;
+  for (int c = 1; c < count; ++c) {
+    if (cov[c][c] > cov[start][start]) start = c;
+  }
+  float axis[4]{};
+  std::copy(cov[start], cov[start] + count, axis);
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    float next[4]{};
+    float largest = 0.0f;
+    for (int a = 0; a < count; ++a) {
+      for (int b = 0; b < count; ++b) {
+        next[a] += cov[a][b] * axis[b];
+      }
+      largest = std::max(largest, std::abs(next[a]));
+    }
+    if (largest == 0.0f) break;
+    for (int c = 0; c < count; ++c) {
+      axis[c] = next[c] / largest;
+    }
+  }
+  float length = 0.0f;
+  for (int c = 0; c < count; ++c) {
+    length += axis[c] * axis[c];
+  }
+  length = std::sqrt(length);
+  for (int c = 0; c < count; ++c) {
+    axis[c] = length > 0.0f ? axis[c] / length : 0.0f;
+  }
+
+  float min_t = std::numeric_limits<float>::max();
+  float max_t = std::numeric_limits<float>::lowest();
+  for (const auto &texel : texels) {
+    float t = 0.0f;
+    for (int c = 0; c < count; ++c) {
+      t += (texel[first + c] - mean[c]) * axis[c];
+    }
+    min_t = std::min(min_t, t);
+    max_t = std::max(max_t, t);
+  }
+  for (int c = 0; c < count; ++c) {
+    e0[c] = std::clamp(mean[c] + axis[c] * min_t, 0.0f, 255.0f);
+    e1[c] = std::clamp(mean[c] + axis[c] * max_t, 0.0f, 255.0f);
+  }
+}
+
+// least squares endpoints for the positions of the texels between them,
+// minimizes the sum of |(1 - t) e0 + t e1 - texel|^2
+bool SolveEndpoints(const Texels &texels, int first, int count,
+                    const float t[kTexels], float e0[4], float e1[4]) {
+  float aa = 0.0f;
+  float ab = 0.0f;
+  float bb = 0.0f;
+  float ax[4]{};
+  float bx[4]{};
+  for (int i = 0; i < kTexels; ++i) {
+    const float a = 1.0f - t[i];
+    const float b = t[i];
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+    for (int c = 0; c < count; ++c) {
+      ax[c] += a * texels[i][first + c];
+      bx[c] += b * texels[i][first + c];
+    }
+  }
+  // all texels at one position
+  const float det = aa * bb - ab * ab;
+  if (std::abs(det) < 1e-4f) return false;
+  for (int c = 0; c < count; ++c) {
+    e0[c] = std::clamp((bb * ax[c] - ab * bx[c]) / det, 0.0f, 255.0f);
+    e1[c] = std::clamp((aa * bx[c] - ab * ax[c]) / det, 0.0f, 255.0f);
+  }
+  return true;
+}
+
+// BC1
+
+struct ColorBlock {
+  uint16_t c0;
+  uint16_t c1;
+  uint32_t indices;
+  int error;
+};
+
+uint16_t To565(const float color[4]) {
+  const auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+  const auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+  const auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+  return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+void From565(uint16_t color, int rgb[3]) {
+  const int r = color >> 11;
+  const int g = (color >> 5) & 63;
+  const int b = color & 31;
+  rgb[0] = r << 3 | r >> 2;
+  rgb[1] = g << 2 | g >> 4;
+  rgb[2] = b << 3 | b >> 2;
+}
+
+// 4 colors, the BC3 color block is always decoded in this mode
+void GetBc1Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+  From565(c0, palette[0]);
+  From565(c1, palette[1]);
+  for (int c = 0; c < 3; ++c) {
+    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+  }
+}
+
+// c0 > c1 selects the 4 color mode of BC1 (opaque)
+ColorBlock FitBc1(const Texels &texels, uint16_t c0, uint16_t c1) {
+  if (c0 < c1) std::swap(c0, c1);
+  int palette[4][3];
+  GetBc1Palette(c0, c1, palette);
+  // equal endpoints are decoded in the 3 color mode, only the first matches
+  const int codes = c0 == c1 ? 1 : 4;
+
+  ColorBlock block{c0, c1, 0, 0};
+  for (int i = 0; i < kTexels; ++i) {
+    int best_code = 0;
+    int best_error = std::numeric_limits<int>::max();
+    for (int code = 0; code < codes; ++code) {
+      int error = 0;
+      for (int c = 0; c < 3; ++c) {
+        const int d = palette[code][c] - texels[i][c];
+        error += d * d;
+      }
+      if (error < best_error) {
+        best_error = error;
+        best_code = code;
+      }
+    }
+    block.indices |= static_cast<uint32_t>(best_code) << (2 * i);
+    block.error += best_error;
+  }
+  return block;
+}
+
+void EncodeBc1(const Texels &texels, Quality::Enum quality, uint8_t *out) {
+  float e0[4];
+  float e1[4];
+  GetAxisEndpoints(texels, 0, 3, e0, e1);
+  ColorBlock best = FitBc1(texels, To565(e0), To565(e1));
+
+  const int iterations = quality == Quality::kHigh ? 3 : 1;
+  for (int iteration = 0; iteration < iterations && best.error; ++iteration) {
+    float t[kTexels];
+    for (int i = 0; i < kTexels; ++i) {
+      t[i] = kBc1Weights[(best.indices >> (2 * i)) & 3];
+    }
+    if (!SolveEndpoints(texels, 0, 3, t, e0, e1)) break;
+    const ColorBlock next = FitBc1(texels, To565(e0), To565(e1));
+    if (next.error >= best.error) break;
+    best = next;
+  }
+
+  std::memcpy(out, &best.c0, 2);
+  std::memcpy(out + 2, &best.c1, 2);
+  std::memcpy(out + 4, &best.indices, 4);
+}
+
+void DecodeBc1(const uint8_t *block, bool four_colors, Texels &texels) {
+  uint16_t c0;
+  uint16_t c1;
+  uint32_t indices;
+  std::memcpy(&c0, block, 2);
+  std::memcpy(&c1, block + 2, 2);
+  std::memcpy(&indices, block + 4, 4);
+
+  int palette[4][3];
+  int alpha[4]{255, 255, 255, 255};
+  GetBc1Palette(c0, c1, palette);
+  if (!four_colors && c0 <= c1) {
+    // 3 colors and the transparent black
+    for (int c = 0; c < 3; ++c) {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+      palette[3][c] = 0;
+    }
+    alpha[3] = 0;
+  }
+  for (int i = 0; i < kTexels; ++i) {
+    const uint32_t code = (indices >> (2 * i)) & 3;
+    for (int c = 0; c < 3; ++c) {
+      texels[i][c] = static_cast<uint8_t>(palette[code][c]);
+    }
+    texels[i][3] = static_cast<uint8_t>(alpha[code]);
+  }
+}
+
+// BC4
+
+struct ValueBlock {
+  uint8_t r0;
+  uint8_t r1;
+  uint64_t indices;
+  int error;
+};
+
+// r0 > r1: 8 values, otherwise 6 values, 0 and 255
+void GetBc4Palette(int r0, int r1, int palette[8]) {
+  palette[0] = r0;
+  palette[1] = r1;
+  if (r0 > r1) {
+    for (int k = 1; k < 7; ++k) {
+      palette[k + 1] = ((7 - k) * r0 + k * r1 + 3) / 7;
+    }
+  } else {
+    for (int k = 1; k < 5; ++k) {
+      palette[k + 1] = ((5 - k) * r0 + k * r1 + 2) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+ValueBlock FitBc4(const Texels &texels, int channel, int r0, int r1) {
+  int palette[8];
+  GetBc4Palette(r0, r1, palette);
+
+  ValueBlock block{static_cast<uint8_t>(r0), static_cast<uint8_t>(r1), 0, 0};
+  for (int i = 0; i < kTexels; ++i) {
+    int best_code = 0;
+    int best_error = std::numeric_limits<int>::max();
+    for (int code = 0; code < 8; ++code) {
+      const int d = palette[code] - texels[i][channel];
+      if (d * d < best_error) {
+        best_error = d * d;
+        best_code = code;
+      }
+    }
+    block.indices |= static_cast<uint64_t>(best_code) << (3 * i);
+    block.error += best_error;
+  }
+  return block;
+}
+
+void EncodeBc4(const Texels &texels, int channel, Quality::Enum quality,
+               uint8_t *out) {
+  int low = 255;
+  int high = 0;
+  for (const auto &texel : texels) {
+    low = std::min<int>(low, texel[channel]);
+    high = std::max<int>(high, texel[channel]);
+  }
+  // equal endpoints are the 6 values mode, the first one is exact
+  ValueBlock best = FitBc4(texels, channel, high, low);
+
+  if (quality == Quality::kHigh && best.error) {
+    for (int iteration = 0; iteration < 2 && best.r0 > best.r1; ++iteration) {
+      float t[kTexels];
+      for (int i = 0; i < kTexels; ++i) {
+        t[i] = kBc4Weights[(best.indices >> (3 * i)) & 7];
+      }
+      float e0[4];
+      float e1[4];
+      if (!SolveEndpoints(texels, channel, 1, t, e0, e1)) break;
+      int r0 = Clamp8(std::lround(e0[0]));
+      int r1 = Clamp8(std::lround(e1[0]));
+      if (r0 < r1) std::swap(r0, r1);
+      const ValueBlock next = FitBc4(texels, channel, r0, r1);
+      if (next.error >= best.error) break;
+      best = next;
+    }
+
+    // 0 and 255 are free in the 6 values mode, the rest is between
+    int inner_low = 255;
+    int inner_high = 0;
+    for (const auto &texel : texels) {
+      if (texel[channel] == 0 || texel[channel] == 255) continue;
+      inner_low = std::min<int>(inner_low, texel[channel]);
+      inner_high = std::max<int>(inner_high, texel[channel]);
+    }
+    if (inner_low > inner_high) inner_low = inner_high = 0;
+    const ValueBlock six = FitBc4(texels, channel, inner_low, inner_high);
+    if (six.error < best.error) best = six;
+  }
+
+  out[0] = best.r0;
+  out[1] = best.r1;
+  for (int i = 0; i < 6; ++i) {
+    out[2 + i] = static_cast<uint8_t>(best.indices >> (8 * i));
+  }
+}
+
+void DecodeBc4(const uint8_t *block, int channel, Texels &texels) {
+  int palette[8];
+  GetBc4Palette(block[0], block[1], palette);
+  uint64_t indices = 0;
+  for (int i = 0; i < 6; ++i) {
+    indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+  }
+  for (int i = 0; i < kTexels; ++i) {
+    const uint64_t code = (indices >> (3 * i)) & 7;
+    texels[i][channel] = static_cast<uint8_t>(palette[code]);
+  }
+}
+
+// BC7 mode 6
+
+struct Bc7Block {
+  int q0[4];
+  int q1[4];
+  int p0;
+  int p1;
+  uint8_t indices[kTexels];
+  int error;
+};
+
+// 7 bit endpoint, the p-bit is the lowest bit of the 8 bit value
+int QuantizeBc7(float value, int pbit) {
+  return std::clamp(static_cast<int>(std::lround((value - pbit) / 2.0f)), 0,
+                    127);
+}
+
+// the p-bit closer to the whole endpoint
+int ChooseBc7PBit(const float endpoint[4]) {
+  float errors[2]{};
+  for (int p = 0; p < 2; ++p) {
+    for (int c = 0; c < 4; ++c) {
+      const float d = (QuantizeBc7(endpoint[c], p) << 1 | p) - endpoint[c];
+      errors[p] += d * d;
+    }
+  }
+  return errors[1] < errors[0] ? 1 : 0;
+}
+
+Bc7Block FitBc7(const Texels &texels, const float e0[4], const float e1[4],
+                int p0, int p1) {
+  Bc7Block block{};
+  block.p0 = p0;
+  block.p1 = p1;
+  int palette[16][4];
+  for (int c = 0; c < 4; ++c) {
+    block.q0[c] = QuantizeBc7(e0[c], p0);
+    block.q1[c] = QuantizeBc7(e1[c], p1);
+    const int c0 = block.q0[c] << 1 | p0;
+    const int c1 = block.q1[c] << 1 | p1;
+    for (int k = 0; k < 16; ++k) {
+      palette[k][c] =
+          ((64 - kBc7Weights[k]) * c0 + kBc7Weights[k] * c1 + 32) >> 6;
+    }
+  }
+
+  for (int i = 0; i < kTexels; ++i) {
+    int best_code = 0;
+    int best_error = std::numeric_limits<int>::max();
+    for (int code = 0; code < 16; ++code) {
+      int error = 0;
+      for (int c = 0; c < 4; ++c) {
+        const int d = palette[code][c] - texels[i][c];
+        error += d * d;
+      }
+      if (error < best_error) {
+        best_error = error;
+        best_code = code;
+      }
+    }
+    block.indices[i] = static_cast<uint8_t>(best_code);
+    block.error += best_error;
+  }
+  return block;
+}
+
+// kHigh tries all 4 p-bit pairs
+Bc7Block FitBc7(const Texels &texels, const float e0[4], const float e1[4],
+                Quality::Enum quality) {
+  if (quality == Quality::kFast) {
+    return FitBc7(texels, e0, e1, ChooseBc7PBit(e0), ChooseBc7PBit(e1));
+  }
+  Bc7Block best = FitBc7(texels, e0, e1, 0, 0);
+  for (int pbits = 1; pbits < 4; ++pbits) {
+    const Bc7Block next = FitBc7(texels, e0, e1, pbits & 1, pbits >> 1);
+    if (next.error < best.error) best = next;
+  }
+  return best;
+}
+
+class BitWriter {
+ public:
+  explicit BitWriter(uint8_t *out) : out_(out) {}
+
+  void Put(uint32_t value, int bits) {
+    for (int i = 0; i < bits; ++i, ++pos_) {
+      out_[pos_ >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (pos_ & 7));
+    }
+  }
+
+ private:
+  uint8_t *out_;
+  int pos_{0};
+};
+
+class BitReader {
+ public:
+  explicit BitReader(const uint8_t *in) : in_(in) {}
+
+  uint32_t Get(int bits) {
+    uint32_t value = 0;
+    for (int i = 0; i < bits; ++i, ++pos_) {
+      value |= static_cast<uint32_t>((in_[pos_ >> 3] >> (pos_ & 7)) & 1) << i;
+    }
+    return value;
+  }
+
+ private:
+  const uint8_t *in_;
+  int pos_{0};
+};
+
+void EncodeBc7(const Texels &texels, Quality::Enum quality, uint8_t *out) {
+  float e0[4];
+  float e1[4];
+  GetAxisEndpoints(texels, 0, 4, e0, e1);
+  Bc7Block best = FitBc7(texels, e0, e1, quality);
+
+  const int iterations = quality == Quality::kHigh ? 3 : 1;
+  for (int iteration = 0; iteration < iterations && best.error; ++iteration) {
+    float t[kTexels];
+    for (int i = 0; i < kTexels; ++i) {
+      t[i] = kBc7Weights[best.indices[i]] / 64.0f;
+    }
+    if (!SolveEndpoints(texels, 0, 4, t, e0, e1)) break;
+    const Bc7Block next = FitBc7(texels, e0, e1, quality);
+    if (next.error >= best.error) break;
+    best = next;
+  }
+
+  // the highest bit of the first index is implicit zero (anchor)
+  if (best.indices[0] & 8) {
+    std::swap(best.q0, best.q1);
+    std::swap(best.p0, best.p1);
+    for (auto &index : best.indices) {
+      index = static_cast<uint8_t>(15 - index);
+    }
+  }
+
+  std::memset(out, 0, 16);
+  BitWriter bits(out);
+  bits.Put(1 << 6, 7);
+  for (int c = 0; c < 4; ++c) {
+    bits.Put(best.q0[c], 7);
+    bits.Put(best.q1[c], 7);
+  }
+  bits.Put(best.p0, 1);
+  bits.Put(best.p1, 1);
+  bits.Put(best.indices[0], 3);
+  for (int i = 1; i < kTexels; ++i) {
+    bits.Put(best.indices[i], 4);
+  }
+}
+
+// mode 6 only (the encoder writes nothing else), the rest is zeros
+void DecodeBc7(const uint8_t *block, Texels &texels) {
+  if ((block[0] & 0x7F) != 1 << 6) {
+    std::memset(texels, 0, sizeof(Texels));
+    return;
+  }
+  BitReader bits(block);
+  bits.Get(7);
+  int c0[4];
+  int c1[4];
+  for (int c = 0; c < 4; ++c) {
+    c0[c] = static_cast<int>(bits.Get(7)) << 1;
+    c1[c] = static_cast<int>(bits.Get(7)) << 1;
+  }
+  const int p0 = static_cast<int>(bits.Get(1));
+  const int p1 = static_cast<int>(bits.Get(1));
+  for (int i = 0; i < kTexels; ++i) {
+    const int w = kBc7Weights[bits.Get(i == 0 ? 3 : 4)];
+    for (int c = 0; c < 4; ++c) {
+      texels[i][c] = static_cast<uint8_t>(
+          ((64 - w) * (c0[c] | p0) + w * (c1[c] | p1) + 32) >> 6);
+    }
+  }
+}
+
+}  // namespace
+
+size_t GetBlockSize(Format::Enum format) {
+  static constexpr size_t kBlockSizes[Format::kTotal]{0, 8, 16, 8, 16, 16};
+  return kBlockSizes[format];
+}
+
+size_t GetCompressedSize(Format::Enum format, int width, int height) {
+  return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) *
+         GetBlockSize(format);
+}
+
+void Encode(Format::Enum format, Quality::Enum quality, const uint8_t *pixels,
+            int width, int height, size_t pitch, int num_of_channels,
+            uint8_t *blocks) {
+  const size_t block_size = GetBlockSize(format);
+  if (block_size == 0) return;
+
+  prof::Zone zone("BCn Encode");
+  const int blocks_x = (width + 3) / 4;
+  const int blocks_y = (height + 3) / 4;
+  app::task::ParallelFor(
+      static_cast<size_t>(blocks_x) * blocks_y, [&](size_t begin, size_t end) {
+        Texels texels;
+        for (size_t i = begin; i < end; ++i) {
+          LoadTexels(pixels, width, height, pitch, num_of_channels,
+                     static_cast<int>(i % blocks_x),
+                     static_cast<int>(i / blocks_x), texels);
+          uint8_t *block = blocks + i * block_size;
+          switch (format) {
+            case Format::kBC1:
+              EncodeBc1(texels, quality, block);
+              break;
+            case Format::kBC3:
+              EncodeBc4(texels, 3, quality, block);
+              EncodeBc1(texels, quality, block + 8);
+              break;
+            case Format::kBC4:
+              EncodeBc4(texels, 0, quality, block);
+              break;
+            case Format::kBC5:
+              EncodeBc4(texels, 0, quality, block);
+              EncodeBc4(texels, 1, quality, block + 8);
+              break;
+            case Format::kBC7:
+              EncodeBc7(texels, quality, block);
+              break;
+            default:
+              break;
+          }
+        }
+      },
+      0, app::task::GetPriority());
+}
+
+void Decode(Format::Enum format, const uint8_t *blocks, int width, int height,
+            uint8_t *rgba) {
+  const size_t block_size = GetBlockSize(format);
+  if (block_size == 0) return;
+
+  const int blocks_x = (width + 3) / 4;
+  const int blocks_y = (height + 3) / 4;
+  for (int by = 0; by < blocks_y; ++by) {
+    for (int bx = 0; bx < blocks_x; ++bx) {
+      const uint8_t *block =
+          blocks + (static_cast<size_t>(by) * blocks_x + bx) * block_size;
+      Texels texels;
+      for (auto &texel : texels) {
+        texel[0] = texel[1] = texel[2] = 0;
+        texel[3] = 255;
+      }
+      switch (format) {
+        case Format::kBC1:
+          DecodeBc1(block, false, texels);
+          break;
+        case Format::kBC3:
+          DecodeBc1(block + 8, true, texels);
+          DecodeBc4(block, 3, texels);
+          break;
+        case Format::kBC4:
+          DecodeBc4(block, 0, texels);
+          break;
+        case Format::kBC5:
+          DecodeBc4(block, 0, texels);
+          DecodeBc4(block + 8, 1, texels);
+          break;
+        case Format::kBC7:
+          DecodeBc7(block, texels);
+          break;
+        default:
+          break;
+      }
+
+      for (int y = 0; y < 4 && by * 4 + y < height; ++y) {
+        for (int x = 0; x < 4 && bx * 4 + x < width; ++x) {
+          const size_t pixel =
+              static_cast<size_t>(by * 4 + y) * width + bx * 4 + x;
+          std::memcpy(rgba + pixel * 4, texels[y * 4 + x], 4);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace bc
@@ -0,0 +1,46 @@
+#pragma once
+
+// global
+#include <cstddef>
+#include <cstdint>
+
+// CPU encoder of the BCn block formats (4x4 texels per block), the cooked
+// textures store the blocks as they are uploaded (assets/texture_cache.h)
+// BC1: RGB, 8 bytes, 4 colors on the line between two RGB565 endpoints
+// BC3: RGBA, 16 bytes, BC4 alpha + BC1 color
+// BC4: R, 8 bytes, 8 values between two 8 bit endpoints
+// BC5: RG, 16 bytes, two BC4 blocks
+// BC7: RGBA, 16 bytes, mode 6 only (7777 endpoints + p-bits, 16 colors)
+// no GL here, the benchmarks link it
+namespace bc {
+
+struct Format {
+  enum Enum : uint32_t { kNone, kBC1, kBC3, kBC4, kBC5, kBC7, kTotal };
+};
+
+// kFast: the principal axis endpoints, kHigh: least squares refinement,
+// all p-bits of BC7 and both modes of BC4 (about 4x slower)
+struct Quality {
+  enum Enum : uint32_t { kFast, kHigh, kTotal };
+};
+
+// bytes per block, 0 for kNone
+size_t GetBlockSize(Format::Enum format);
+// the partial blocks on the right and bottom edges are whole
+size_t GetCompressedSize(Format::Enum format, int width, int height);
+
+// pixels: rows of pitch bytes, num_of_channels 8 bit channels per texel
+// BC1/BC3/BC7 read RGB(A), alpha is 255 without the 4th channel
+// BC4 reads the first channel, BC5 the first two
+// the partial blocks repeat the last column and row
+// blocks are encoded in parallel (app/parallel.h) at the caller's priority,
+// the texture loads stay behind the frame jobs
+void Encode(Format::Enum format, Quality::Enum quality, const uint8_t *pixels,
+            int width, int height, size_t pitch, int num_of_channels,
+            uint8_t *blocks);
+// reference decoder to packed RGBA8 (width * height * 4 bytes)
+// BC4 is (r, 0, 0, 255) and BC5 (r, g, 0, 255) like the GPU samples them
+void Decode(Format::Enum format, const uint8_t *blocks, int width, int height,
+            uint8_t *rgba);
+
+}  // namespace bc
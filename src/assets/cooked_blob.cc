@@ -0,0 +1,108 @@
+#include "cooked_blob.h"
+
+// deps
+#include <spdlog/spdlog.h>
+// global
+#include <fstream>
+
+namespace cooked {
+
+namespace {
+
+const fs::path kResourcesDir{"resources"};
+const fs::path kCacheDir{"resources/cache"};
+
+// no cryptography, the accidental changes only
+// 4 lanes of 8 bytes, a few GB/s (the source is mapped)
+uint64_t Hash(std::span<const char> data) {
+  constexpr uint64_t kPrime = 0x9E3779B97F4A7C15ULL;
+  auto mix = [](uint64_t hash, uint64_t word) {
+    word *= kPrime;
+    word ^= word >> 31;
+    return (hash ^ word) * kPrime;
+  };
+  auto load = [&data](size_t offset) {
+    uint64_t word;
+    std::memcpy(&word, data.data() + offset, sizeof(word));
+    return word;
+  };
+
+  uint64_t lanes[4] = {1, 2, 3, 4};
+  size_t i = 0;
+  for (; i + 32 <= data.size(); i += 32) {
+    lanes[0] = mix(lanes[0], load(i));
+    lanes[1] = mix(lanes[1], load(i + 8));
+    lanes[2] = mix(lanes[2], load(i + 16));
+    lanes[3] = mix(lanes[3], load(i + 24));
+  }
+  uint64_t hash = mix(data.size(), lanes[0]);
+  hash = mix(hash, lanes[1]);
+  hash = mix(hash, lanes[2]);
+  hash = mix(hash, lanes[3]);
+  for (; i < data.size(); ++i) {
+    hash = mix(hash, static_cast<unsigned char>(data[i]));
+  }
+  return hash;
+}
+
+}  // namespace
+
+Key MakeKey(std::span<const char> source, uint32_t import_flags) {
+  return Key{.source_hash = Hash(source),
+             .source_size = source.size(),
+             .import_flags = import_flags};
+}
+
+void WriteHeader(Writer &writer, uint32_t magic, uint32_t version,
+                 const Key &key) {
+  writer.Pod(magic);
+  writer.Pod(version);
+  writer.Pod(key.source_hash);
+  writer.Pod(key.source_size);
+  writer.Pod(key.import_flags);
+}
+
+bool ReadHeader(Reader &reader, uint32_t magic, uint32_t version,
+                const Key &key) {
+  return reader.Pod<uint32_t>() == magic &&
+         reader.Pod<uint32_t>() == version &&
+         reader.Pod<uint64_t>() == key.source_hash &&
+         reader.Pod<uint64_t>() == key.source_size &&
+         reader.Pod<uint32_t>() == key.import_flags;
+}
+
+fs::path GetCachePath(const fs::path &source, const char *extension) {
+  // the same file names in the different directories
+  fs::path relative = source.lexically_relative(kResourcesDir);
+  if (relative.empty() || *relative.begin() == "..") {
+    relative = source.filename();
+  }
+  relative += extension;
+  return kCacheDir / relative;
+}
+
+bool Save(const fs::path &path, const Blob &blob) {
+  std::error_code error;
+  fs::create_directories(path.parent_path(), error);
+
+  // a crash or a concurrent reader never sees a partial file
+  fs::path temp = path;
+  temp += ".tmp";
+  {
+    std::ofstream file(temp, std::ios_base::binary | std::ios_base::trunc);
+    if (!file.write(blob.data(), blob.size())) {
+      spdlog::error("{}: Failed to write '{}'", __FUNCTION__, temp.string());
+      return false;
+    }
+  }
+  fs::rename(temp, path, error);
+  if (error) {
+    spdlog::error("{}: Failed to rename '{}': {}", __FUNCTION__, temp.string(),
+                  error.message());
+    fs::remove(temp, error);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace cooked
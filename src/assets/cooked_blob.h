@@ -0,0 +1,138 @@
+#pragma once
+
+// global
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+// local
+#include "files.h"
+#include "mem_info.h"
+
+// binary blob of the cooked assets (assets/model_cache.h)
+// native layout, PODs as is, a header with the magic, version and key
+// the reader and writer are header-only (used by the benchmarks)
+namespace cooked {
+
+// the views into the blob are aligned for any glm type and SIMD loads
+inline constexpr size_t kAlignment = 16;
+
+using Blob = mem::TagVector<char, mem::Tag::kAssets>;
+
+// arrays are 16 bytes aligned, the views point into the blob
+class Writer {
+ public:
+  explicit Writer(Blob &blob) : blob_(blob) {}
+
+  template <typename T>
+  void Pod(const T &value) {
+    Bytes(&value, sizeof(T));
+  }
+  template <typename T>
+  void Array(std::span<const T> values) {
+    Pod(static_cast<uint32_t>(values.size()));
+    Align();
+    Bytes(values.data(), values.size_bytes());
+  }
+  void String(std::string_view str) {
+    Pod(static_cast<uint32_t>(str.size()));
+    Bytes(str.data(), str.size());
+  }
+
+ private:
+  Blob &blob_;
+
+  void Bytes(const void *data, size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    blob_.insert(blob_.end(), bytes, bytes + size);
+  }
+  void Align() {
+    blob_.resize((blob_.size() + kAlignment - 1) & ~(kAlignment - 1), 0);
+  }
+};
+
+// bounds checked, a failed read returns empty values and the reader
+// stays failed (checked once at the end)
+class Reader {
+ public:
+  explicit Reader(std::span<const char> blob) : blob_(blob) {}
+
+  bool IsOk() const { return ok_; }
+  bool IsEnd() const { return offset_ == blob_.size(); }
+  void Fail() { ok_ = false; }
+
+  template <typename T>
+  T Pod() {
+    T value{};
+    if (const char *data = Bytes(sizeof(T))) {
+      std::memcpy(&value, data, sizeof(T));
+    }
+    return value;
+  }
+  // of the following records, fails if more than the bytes left
+  uint32_t Count() {
+    const uint32_t count = Pod<uint32_t>();
+    if (count > blob_.size() - offset_) ok_ = false;
+    return ok_ ? count : 0;
+  }
+  template <typename T>
+  std::span<const T> Array() {
+    const uint32_t count = Pod<uint32_t>();
+    Align();
+    const char *data = Bytes(count * sizeof(T));
+    if (!data) return {};
+    return {reinterpret_cast<const T *>(data), count};
+  }
+  std::string_view String() {
+    const uint32_t size = Pod<uint32_t>();
+    const char *data = Bytes(size);
+    if (!data) return {};
+    return {data, size};
+  }
+
+ private:
+  std::span<const char> blob_;
+  size_t offset_{0};
+  bool ok_{true};
+
+  const char *Bytes(size_t size) {
+    if (!ok_ || size > blob_.size() - offset_) {
+      ok_ = false;
+      return nullptr;
+    }
+    const char *data = blob_.data() + offset_;
+    offset_ += size;
+    return data;
+  }
+  void Align() {
+    const size_t aligned = (offset_ + kAlignment - 1) & ~(kAlignment - 1);
+    if (aligned > blob_.size()) {
+      ok_ = false;
+      return;
+    }
+    offset_ = aligned;
+  }
+};
+
+// the cache is valid for the same source and the same import
+struct Key {
+  uint64_t source_hash{0};
+  uint64_t source_size{0};
+  // what changes the output besides the source (e.g. Assimp flags)
+  uint32_t import_flags{0};
+};
+
+// the hash of the whole file (mapped), size and flags are cheap to compare
+Key MakeKey(std::span<const char> source, uint32_t import_flags);
+void WriteHeader(Writer &writer, uint32_t magic, uint32_t version,
+                 const Key &key);
+// false if another asset type, version or key
+bool ReadHeader(Reader &reader, uint32_t magic, uint32_t version,
+                const Key &key);
+
+// resources/cache/<source relative to resources>.<extension>
+fs::path GetCachePath(const fs::path &source, const char *extension);
+// written to a temporary file and renamed
+bool Save(const fs::path &path, const Blob &blob);
+
+}  // namespace cooked
@@ -0,0 +1,289 @@
+#include "loading_report.h"
+
+// deps
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+// global
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+// local
+#include "app/main_thread.h"
+#include "app/task_system.h"
+#include "mi_types.h"
+
+namespace loading {
+
+namespace {
+
+constexpr const char *kPhaseNames[Phase::kTotal]{
+    "file_read",          //
+    "import",             //
+    "vertex_extraction",  //
+    "texture_decode",     //
+    "gl_upload",          //
+    "main_thread_wait",   //
+    "shared_wait",        //
+};
+
+// not recorded, -1 is the main thread
+constexpr int kNoThread = -2;
+// neither a worker nor the main thread (the detached loading thread)
+constexpr int kOtherThread = -3;
+
+struct PhaseRecord {
+  float ms{0.0f};
+  uint64_t bytes{0};
+  // the last thread that recorded the phase
+  int thread{kNoThread};
+};
+
+struct Record {
+  std::string name;
+  const char *kind;
+  Asset parent;
+  int64_t start_ns;
+  // 0 until End()
+  int64_t end_ns;
+  std::array<PhaseRecord, Phase::kTotal> phases;
+};
+
+std::atomic<bool> gReporting = false;
+int64_t gStart = 0;
+// a few records per asset, the lock is cold
+std::mutex gMutex;
+MiVector<Record> gRecords;
+thread_local Asset tCurrent = kNone;
+
+int64_t NowNs() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+float ToMs(int64_t ns) { return static_cast<float>(ns) * 1e-6f; }
+
+// paths on Windows
+std::string Escape(const std::string &str) {
+  std::string result;
+  result.reserve(str.size());
+  for (char c : str) {
+    if (c == '"' || c == '\\') result += '\\';
+    if (static_cast<unsigned char>(c) < 0x20) continue;
+    result += c;
+  }
+  return result;
+}
+
+int CurrentThread() {
+  const int worker = app::task::GetWorkerIndex();
+  if (worker >= 0 || app::main_thread::IsMainThread()) return worker;
+  return kOtherThread;
+}
+
+std::string ThreadName(int thread) {
+  if (thread == -1) return "main";
+  if (thread == kOtherThread) return "other";
+  return fmt::format("worker {}", thread);
+}
+
+bool IsWait(int phase) {
+  return phase == Phase::kMainThreadWait || phase == Phase::kSharedWait;
+}
+
+// the time on the CPU and GL workers, without the waits
+float BusyMs(const Record &record) {
+  float busy = 0.0f;
+  for (int i = 0; i < Phase::kTotal; ++i) {
+    if (!IsWait(i)) busy += record.phases[i].ms;
+  }
+  return busy;
+}
+
+// the queues of the workers and the untimed work
+float OtherMs(const Record &record) {
+  const float total = ToMs(record.end_ns - record.start_ns);
+  float wait = 0.0f;
+  for (int i = 0; i < Phase::kTotal; ++i) {
+    if (IsWait(i)) wait += record.phases[i].ms;
+  }
+  return std::max(total - BusyMs(record) - wait, 0.0f);
+}
+
+void WriteRecord(std::ofstream &file, const Record &record) {
+  file << fmt::format(
+      "{{\"name\":\"{}\",\"kind\":\"{}\",\"parent\":{},"
+      "\"start_ms\":{:.3f},\"end_ms\":{:.3f},\"total_ms\":{:.3f},"
+      "\"other_ms\":{:.3f},\"phases\":{{",
+      Escape(record.name), record.kind, record.parent,
+      ToMs(record.start_ns - gStart), ToMs(record.end_ns - gStart),
+      ToMs(record.end_ns - record.start_ns), OtherMs(record));
+  bool first = true;
+  for (int i = 0; i < Phase::kTotal; ++i) {
+    const auto &phase = record.phases[i];
+    if (phase.thread == kNoThread) continue;
+    file << fmt::format(
+        "{}\"{}\":{{\"ms\":{:.3f},\"bytes\":{},\"thread\":\"{}\"}}",
+        first ? "" : ",", kPhaseNames[i], phase.ms, phase.bytes,
+        ThreadName(phase.thread));
+    first = false;
+  }
+  file << "}}";
+}
+
+// the nested assets are in their parents, only the roots are summed
+void WriteSummary(std::ofstream &file, const MiVector<Record> &records) {
+  std::array<PhaseRecord, Phase::kTotal> totals{};
+  int64_t first_start = 0;
+  int64_t last_end = 0;
+  float busy = 0.0f;
+  const Record *critical = nullptr;
+  const Record *longest = nullptr;
+  size_t roots = 0;
+  for (const auto &record : records) {
+    if (record.parent != kNone) continue;
+    for (int i = 0; i < Phase::kTotal; ++i) {
+      totals[i].ms += record.phases[i].ms;
+      totals[i].bytes += record.phases[i].bytes;
+    }
+    busy += BusyMs(record);
+    if (roots == 0 || record.start_ns < first_start) {
+      first_start = record.start_ns;
+    }
+    if (!critical || record.end_ns > critical->end_ns) critical = &record;
+    if (!longest || record.end_ns - record.start_ns >
+                        longest->end_ns - longest->start_ns) {
+      longest = &record;
+    }
+    last_end = std::max(last_end, record.end_ns);
+    ++roots;
+  }
+
+  const float wall = roots ? ToMs(last_end - first_start) : 0.0f;
+  file << fmt::format(
+      "\"summary\":{{\"assets\":{},\"wall_ms\":{:.3f},\"busy_ms\":{:.3f},"
+      "\"parallelism\":{:.2f},\"phases\":{{",
+      roots, wall, busy, wall > 0.0f ? busy / wall : 0.0f);
+  for (int i = 0; i < Phase::kTotal; ++i) {
+    file << fmt::format("{}\"{}\":{{\"ms\":{:.3f},\"bytes\":{}}}",
+                        i ? "," : "", kPhaseNames[i], totals[i].ms,
+                        totals[i].bytes);
+  }
+  file << "}";
+
+  // the loading ends with this asset, its phases and waits are the
+  // critical path
+  if (critical) {
+    int dominant = 0;
+    for (int i = 1; i < Phase::kTotal; ++i) {
+      if (critical->phases[i].ms > critical->phases[dominant].ms) dominant = i;
+    }
+    file << fmt::format(
+        ",\"critical_path\":{{\"asset\":\"{}\",\"start_ms\":{:.3f},"
+        "\"end_ms\":{:.3f},\"busy_ms\":{:.3f},\"other_ms\":{:.3f},"
+        "\"dominant_phase\":\"{}\"}}",
+        Escape(critical->name), ToMs(critical->start_ns - first_start),
+        ToMs(critical->end_ns - first_start), BusyMs(*critical),
+        OtherMs(*critical), kPhaseNames[dominant]);
+    file << fmt::format(",\"longest\":{{\"asset\":\"{}\",\"ms\":{:.3f}}}",
+                        Escape(longest->name),
+                        ToMs(longest->end_ns - longest->start_ns));
+  }
+  file << "}";
+}
+
+}  // namespace
+
+Asset Begin(const std::string &name, const char *kind) {
+  if (!gReporting.load(std::memory_order_relaxed)) return kNone;
+  std::scoped_lock lock(gMutex);
+  gRecords.push_back({name, kind, tCurrent, NowNs(), 0, {}});
+  return static_cast<Asset>(gRecords.size() - 1);
+}
+
+void End(Asset asset) {
+  if (asset == kNone) return;
+  std::scoped_lock lock(gMutex);
+  // restarted report
+  if (static_cast<size_t>(asset) >= gRecords.size()) return;
+  auto &record = gRecords[asset];
+  record.end_ns = NowNs();
+  if (record.parent == kNone) return;
+
+  auto &parent = gRecords[record.parent];
+  for (int i = 0; i < Phase::kTotal; ++i) {
+    const auto &phase = record.phases[i];
+    if (phase.thread == kNoThread) continue;
+    parent.phases[i].ms += phase.ms;
+    parent.phases[i].bytes += phase.bytes;
+    parent.phases[i].thread = phase.thread;
+  }
+}
+
+void Add(Asset asset, Phase::Enum phase, float ms, uint64_t bytes) {
+  if (asset == kNone) return;
+  const int thread = CurrentThread();
+  std::scoped_lock lock(gMutex);
+  if (static_cast<size_t>(asset) >= gRecords.size()) return;
+  auto &record = gRecords[asset].phases[phase];
+  record.ms += ms;
+  record.bytes += bytes;
+  record.thread = thread;
+}
+
+Scope::Scope(Asset asset) noexcept : previous_(tCurrent) { tCurrent = asset; }
+
+Scope::~Scope() noexcept { tCurrent = previous_; }
+
+PhaseTimer::PhaseTimer(Phase::Enum phase) noexcept
+    : asset_(tCurrent), phase_(phase) {}
+
+PhaseTimer::~PhaseTimer() noexcept { End(); }
+
+void PhaseTimer::End() noexcept {
+  if (asset_ == kNone) return;
+  Add(asset_, phase_, counter_.GetElapsed<prof::fms>(), bytes_);
+  asset_ = kNone;
+}
+
+void StartReport() {
+  std::scoped_lock lock(gMutex);
+  gRecords.clear();
+  gStart = NowNs();
+  gReporting = true;
+}
+
+bool IsReporting() { return gReporting; }
+
+bool SaveReport(const std::string &filename) {
+  gReporting = false;
+  std::ofstream file(filename);
+  if (!file) {
+    spdlog::error("{}: Failed to open '{}'", __FUNCTION__, filename);
+    return false;
+  }
+
+  std::scoped_lock lock(gMutex);
+  // unfinished (failed) assets end now
+  const int64_t now = NowNs();
+  for (auto &record : gRecords) {
+    if (record.end_ns == 0) record.end_ns = now;
+  }
+
+  file << "{\"assets\":[";
+  for (size_t i = 0; i < gRecords.size(); ++i) {
+    file << (i ? ",\n" : "\n");
+    WriteRecord(file, gRecords[i]);
+  }
+  file << "\n],\n";
+  WriteSummary(file, gRecords);
+  file << "}\n";
+
+  spdlog::info("{}: {} assets saved to '{}'", __FUNCTION__, gRecords.size(),
+               filename);
+  return true;
+}
+
+}  // namespace loading
@@ -0,0 +1,80 @@
+#pragma once
+
+// global
+#include <cstdint>
+#include <string>
+// local
+#include "utils/profiling.h"
+
+// per asset breakdown of the loading, where the time went and on which thread
+// recorded between StartReport() and SaveReport(), the rest is a no-op
+namespace loading {
+
+struct Phase {
+  enum Enum : int {
+    kFileRead,
+    // Assimp post-processing, without the file read
+    kImport,
+    kVertexExtraction,
+    kTextureDecode,
+    kGlUpload,
+    // the hop to the main context for the bindless handles
+    kMainThreadWait,
+    // another thread loads the same file (TextureManager single flight)
+    kSharedWait,
+    kTotal
+  };
+};
+
+// index of the record, kNone if not recording
+using Asset = int;
+inline constexpr Asset kNone = -1;
+
+// kind is a string literal ("model", "texture"), the pointer is stored
+// the current asset of the thread becomes the parent, a nested asset
+// (the textures of a model) is added to the parent by End()
+Asset Begin(const std::string &name, const char *kind);
+void End(Asset asset);
+// accumulates, stores the calling thread (worker, main or other thread)
+void Add(Asset asset, Phase::Enum phase, float ms, uint64_t bytes = 0);
+
+// the asset of the synchronous code on this thread (e.g. Model constructor)
+// a coroutine scope must not cross co_await (the thread can change)
+class Scope {
+ public:
+  explicit Scope(Asset asset) noexcept;
+  ~Scope() noexcept;
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+ private:
+  Asset previous_;
+};
+
+// times the phase of the current asset of the thread, no-op without one
+class PhaseTimer {
+ public:
+  explicit PhaseTimer(Phase::Enum phase) noexcept;
+  ~PhaseTimer() noexcept;
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  void AddBytes(uint64_t bytes) { bytes_ += bytes; }
+  // records now, the destructor does nothing
+  void End() noexcept;
+
+ private:
+  Asset asset_;
+  Phase::Enum phase_;
+  uint64_t bytes_{0};
+  prof::Counter counter_;
+};
+
+// clears the previous report
+void StartReport();
+bool IsReporting();
+// JSON: assets with phases, summary with per phase totals
+// and the critical path (the asset that finished last), stops the report
+bool SaveReport(const std::string &filename);
+
+}  // namespace loading
@@ -2,6 +2,8 @@
 
 // global
 #include <memory>
+#include <string>
+#include <string_view>
 // local
 #include "assets/texture.h"
 #include "global.h"
@@ -10,9 +12,12 @@
 // fwd
 class ModelManager;
 class TextureManager;
-struct Skeleton;
 struct aiMesh;
 struct aiMaterial;
+namespace cooked {
+struct MaterialData;
+struct MeshData;
+}  // namespace cooked
 
 namespace gpu {
 
@@ -56,14 +61,21 @@ struct BufferType {
   };
 };
 
+// kCompact (assets/vertex_format.h): the static meshes pack the normals,
+// the tangents and the tex coords, the skinned ones the bones and weights
+struct VertexFormat {
+  enum Enum : GLuint { kFull, kCompact };
+};
+
 using Textures = std::array<std::shared_ptr<SmartTexture>, TextureType::kTotal>;
 
+// the material's paths are relative to the resources
+std::string GetTexturePath(std::string_view material_path);
+
 class Mesh {
  public:
-  Mesh(aiMesh *mesh, aiMaterial *material, const MeshInfo &load_info,
-       ModelManager &models);
-  Mesh(aiMesh *mesh, aiMaterial *material, const MeshInfo &load_info,
-       Skeleton &skeleton, ModelManager &models);
+  // streams are uploaded from the cooked blob (assets/model_cache.h)
+  Mesh(const cooked::MeshData &data, ModelManager &models);
 
  public:
   gpu::Material material_;
@@ -88,17 +100,11 @@ class Mesh {
   Textures textures_{};
   AABB bb_;
 
-  void ProcessMesh(aiMesh *mesh, aiMaterial *material,
-                   const MeshInfo &load_info);
-  void ExtractIndices(aiMesh *mesh, MiVector<unsigned int> &indices);
-  void UploadStatic(aiMesh *mesh, gl::VertexBuffers &buffers) noexcept;
-  void ExtractBoneWeight(aiMesh *mesh, Skeleton &skeleton,
-                         MiVector<glm::ivec4> &bones,
-                         MiVector<glm::vec4> &weights);
-  void UploadSkinned(aiMesh *mesh, Skeleton &skeleton,
-                     gl::VertexBuffers &buffers) noexcept;
-  void CheckTransparency(const char *mat_name);
-  void ProcessTextures(aiMaterial *material, TextureManager &textures);
+  void Upload(const cooked::MeshData &data,
+              gl::VertexBuffers &buffers) noexcept;
+  void CheckTransparency(std::string_view mat_name);
+  void ProcessTextures(const cooked::MaterialData &material,
+                       TextureManager &textures);
   // debug
   void PrintProps(aiMaterial *material) const;
 };
\ No newline at end of file
@@ -1,78 +1,28 @@
 #include "model.h"
 
-// deps
-#include <assimp/scene.h>
-#include <spdlog/spdlog.h>
 // local
+#include "assets/model_cache.h"
 #include "assets/model_manager.h"
+#include "utils/profiling.h"
 
-bool WrongBuffer(GLuint check_type, GLuint buffer_type, aiMesh *mesh) {
-  if (check_type == buffer_type) return false;
-  spdlog::error("{}: '{}'", __FUNCTION__, mesh->mName.C_Str());
-  return true;
-}
-
-void Model::LoadStaticMeshes(const aiScene *scene, ModelManager &models) {
-  meshes_.reserve(scene->mNumMeshes);
-  auto &buffer = models.mesh_static_;
-
-  for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-    aiMesh *mesh = scene->mMeshes[i];
-    MeshInfo info{mesh};
-    if (WrongBuffer(BufferType::kStatic, info.buffer_type, mesh)) continue;
-    if (buffer.NotEnoughSpaceMt(info.vertex_count, info.indice_count)) continue;
-
-    aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-    meshes_.emplace_back(mesh, material, info, models);
-  }
-}
-
-Skeleton PrepareSkeleton(const aiScene *scene) {
-  unsigned int total_bones = 0;
-  for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-    aiMesh *mesh = scene->mMeshes[i];
-    total_bones += mesh->mNumBones;
-  }
-  return Skeleton{total_bones};
-}
-
-void Model::LoadSkinnedMeshes(Skeleton &skeleton, const aiScene *scene,
-                              ModelManager &models) {
-  // the scene contains all data, the nodes is just to keep stuff organized
-  meshes_.reserve(scene->mNumMeshes);
-  auto &buffer = models.mesh_skinned_;
-
-  for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-    aiMesh *mesh = scene->mMeshes[i];
-    MeshInfo info{mesh};
-    if (WrongBuffer(BufferType::kSkinned, info.buffer_type, mesh)) continue;
-    if (buffer.NotEnoughSpaceMt(info.vertex_count, info.indice_count)) continue;
-
-    aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-    meshes_.emplace_back(mesh, material, info, skeleton, models);
-  }
-}
-
-void Model::LoadAnimations(Skeleton &skeleton, const aiScene *scene) {
-  aiNode *root_node = scene->mRootNode;
-  animations_.reserve(scene->mNumAnimations);
-  for (unsigned int i = 0; i < scene->mNumAnimations; ++i) {
-    aiAnimation *animation = scene->mAnimations[i];
-    animations_.emplace_back(animation, root_node, skeleton);
-  }
-}
-
-Model::Model(const std::string &name, const aiScene *scene,
+Model::Model(const std::string &name, cooked::ModelData &data,
              ModelManager &models)
-    : id_(id::GenId(id::kModel)), name_(name) {
-  if (scene->HasAnimations()) {
-    Skeleton skeleton = PrepareSkeleton(scene);
-    LoadSkinnedMeshes(skeleton, scene, models);
-    // load animations when Skeleton processed
-    LoadAnimations(skeleton, scene);
-    skeleton_ = std::move(skeleton);
-  } else {
-    LoadStaticMeshes(scene, models);
+    : id_(id::GenId(id::kModel)),
+      name_(name),
+      animations_(std::move(data.animations)),
+      skeleton_(std::move(data.skeleton)) {
+  prof::Zone zone("Model::Model");
+  meshes_.reserve(data.meshes.size());
+  for (const auto &mesh : data.meshes) {
+    auto &buffer = mesh.buffer_type == BufferType::kSkinned
+                       ? models.mesh_skinned_
+                       : models.mesh_static_;
+    if (buffer.NotEnoughSpaceMt(mesh.vertex_count, mesh.indice_count)) {
+      // the keyframe boxes are per mesh index, keep them in order
+      if (HasAnimations()) break;
+      continue;
+    }
+    meshes_.emplace_back(mesh, models);
   }
 
   if (meshes_.size() == 0) return;
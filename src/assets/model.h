@@ -7,11 +7,15 @@
 // fwd
 class ModelManager;
 class TextureManager;
-struct aiScene;
+namespace cooked {
+struct ModelData;
+}  // namespace cooked
 
 class Model {
  public:
-  Model(const std::string &name, const aiScene *scene, ModelManager &models);
+  // uploads the streams, takes the skeleton and the animations
+  Model(const std::string &name, cooked::ModelData &data,
+        ModelManager &models);
 
  public:
   MiVector<Mesh> meshes_;
@@ -38,10 +42,4 @@ class Model {
 
   MiVector<Animation> animations_;
   Skeleton skeleton_;
-
-  void LoadStaticMeshes(const aiScene *scene, ModelManager &models);
-
-  void LoadSkinnedMeshes(Skeleton &skeleton, const aiScene *scene,
-                         ModelManager &models);
-  void LoadAnimations(Skeleton &skeleton, const aiScene *scene);
 };
@@ -0,0 +1,475 @@
+#include "model_cache.h"
+
+// deps
+#include <assimp/scene.h>
+#include <spdlog/spdlog.h>
+// local
+#include "app/parallel.h"
+#include "assets/assimp_blender.h"
+#include "assets/loading_report.h"
+#include "assets/mesh.h"
+#include "assets/vertex_cache.h"
+#include "assets/vertex_data.h"
+#include "assets/vertex_format.h"
+#include "math/assimp_to_glm.h"
+
+namespace cooked {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x4D4B4A2E;  // ".JKM"
+
+// the positions, normals and tangents are taken as is
+static_assert(sizeof(aiVector3D) == sizeof(glm::vec3));
+
+std::span<const glm::vec3> AsVec3(const aiVector3D *data, size_t count) {
+  return {reinterpret_cast<const glm::vec3 *>(data), count};
+}
+
+// the streams of one mesh in the optimized vertex order
+// remap[assimp vertex] = cooked vertex (the bones are extracted later)
+// kCompact: the packed streams replace the normals, the tangents, the
+// bitangents and the tex coords
+struct MeshStreams {
+  vertex::Stream<glm::vec3> positions;
+  vertex::Stream<glm::vec3> normals;
+  vertex::Stream<glm::vec3> tangents;
+  vertex::Stream<glm::vec3> bitangents;
+  vertex::Stream<float> tex_coords;
+  vertex::Stream<uint32_t> packed_normals;
+  vertex::Stream<uint32_t> packed_tangents;
+  vertex::Stream<uint32_t> packed_tex_coords;
+  vertex::Stream<unsigned int> indices;
+  vertex::Stream<unsigned int> remap;
+  vertex::CacheStats source;
+  vertex::CacheStats optimized;
+};
+
+// the bytes of the cooked vertex streams
+size_t GetStreamBytes(const MeshStreams &streams) {
+  return (streams.positions.size() + streams.normals.size() +
+          streams.tangents.size() + streams.bitangents.size()) *
+             sizeof(glm::vec3) +
+         streams.tex_coords.size() * sizeof(float) +
+         (streams.packed_normals.size() + streams.packed_tangents.size() +
+          streams.packed_tex_coords.size()) *
+             sizeof(uint32_t);
+}
+
+void PackStreams(MeshStreams &streams) {
+  const size_t vertex_count = streams.positions.size();
+  streams.packed_normals.resize(vertex_count);
+  streams.packed_tangents.resize(vertex_count);
+  streams.packed_tex_coords.resize(vertex_count);
+  for (size_t v = 0; v < vertex_count; ++v) {
+    const glm::vec3 &normal = streams.normals[v];
+    streams.packed_normals[v] = vertex::PackNormal(normal);
+    streams.packed_tangents[v] = vertex::PackTangent(
+        normal, streams.tangents[v], streams.bitangents[v]);
+    streams.packed_tex_coords[v] = vertex::PackTexCoords(
+        streams.tex_coords[v * 2 + 0], streams.tex_coords[v * 2 + 1]);
+  }
+  streams.normals = {};
+  streams.tangents = {};
+  streams.bitangents = {};
+  streams.tex_coords = {};
+}
+
+void ExtractStreams(const aiMesh *mesh, GLuint vertex_format,
+                    MeshStreams &streams) {
+  const MeshInfo info{mesh};
+  const size_t vertex_count = info.vertex_count;
+  vertex::Stream<float> tex_coords;
+  vertex::ExtractTexCoords(mesh, tex_coords);
+  auto &indices = streams.indices;
+  indices.reserve(info.indice_count);
+  vertex::ExtractIndices(mesh, indices);
+  // triangles only, see MeshInfo
+  indices.resize(info.indice_count, 0);
+
+  const auto positions = AsVec3(mesh->mVertices, vertex_count);
+  const bool triangles = mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
+  streams.source = vertex::GetCacheStats(indices, vertex_count);
+  if (triangles) vertex::OptimizeTriangles(indices, positions);
+  streams.optimized = vertex::GetCacheStats(indices, vertex_count);
+
+  vertex::OptimizeVertexFetch(indices, vertex_count, streams.remap);
+  const auto &remap = streams.remap;
+  vertex::RemapStream(positions, remap, 1, streams.positions);
+  vertex::RemapStream(AsVec3(mesh->mNormals, vertex_count), remap, 1,
+                      streams.normals);
+  vertex::RemapStream(AsVec3(mesh->mTangents, vertex_count), remap, 1,
+                      streams.tangents);
+  vertex::RemapStream(AsVec3(mesh->mBitangents, vertex_count), remap, 1,
+                      streams.bitangents);
+  vertex::RemapStream(std::span<const float>(tex_coords), remap, 2,
+                      streams.tex_coords);
+  if (vertex_format == VertexFormat::kCompact) PackStreams(streams);
+}
+
+void CookMaterial(const aiMaterial *material, Writer &writer) {
+  // data comes from Blender's BSDF node
+  // FBX doesn't support PBR well, but Blender exports all we need anyway
+  // source: export_fbx_bin.py
+  aiColor3D color_diffuse;
+  float metallic_factor = 0.0f;
+  float roughness_factor = 0.0f;
+  aiColor3D color_emission;
+  // Blender exports emission strength but Assimp doesn't load, bug?
+  constexpr float emission_factor = 1.0f;
+  float transparency_factor = 0.0f;
+  material->Get(AI_MATKEY_COLOR_DIFFUSE, color_diffuse);
+  material->Get(AI_MATKEY_REFLECTIVITY, metallic_factor);
+  material->Get(AI_MATKEY_ROUGHNESS_FACTOR, roughness_factor);
+  material->Get(AI_MATKEY_COLOR_EMISSIVE, color_emission);
+  //   material->Get(AI_MATKEY_EMISSIVE_INTENSITY, emission_factor);
+  material->Get(AI_MATKEY_TRANSPARENCYFACTOR, transparency_factor);
+
+  writer.String(material->GetName().C_Str());
+  writer.Pod(glm::vec4(color_diffuse.r, color_diffuse.g, color_diffuse.b,
+                       transparency_factor));
+  writer.Pod(glm::vec4(color_emission.r, color_emission.g, color_emission.b,
+                       emission_factor));
+  writer.Pod(roughness_factor);
+  writer.Pod(metallic_factor);
+
+  std::array<aiString, TextureType::kTotal> paths;
+  material->Get(AI_MATKEY_FBX_BLENDER_DIFFUSE_TEXTURE,
+                paths[TextureType::kDiffuse]);
+  material->Get(AI_MATKEY_FBX_BLENDER_METALLIC_TEXTURE,
+                paths[TextureType::kMetallic]);
+  material->Get(AI_MATKEY_FBX_BLENDER_ROUGHNESS_TEXTURE,
+                paths[TextureType::kRoughness]);
+  material->Get(AI_MATKEY_FBX_BLENDER_EMISSIVE_TEXTURE,
+                paths[TextureType::kEmissive]);
+  material->Get(AI_MATKEY_FBX_BLENDER_EMISSIVE_FACTOR_TEXTURE,
+                paths[TextureType::kEmissiveFactor]);
+  material->Get(AI_MATKEY_FBX_BLENDER_NORMALS_TEXTURE,
+                paths[TextureType::kNormals]);
+  for (const auto &path : paths) {
+    writer.String({path.C_Str(), path.length});
+  }
+}
+
+// the skin is validated against the float path, the errors of all meshes
+void CookMesh(const aiMesh *mesh, const aiMaterial *material,
+              const MeshInfo &info, GLuint vertex_format,
+              const MeshStreams &streams, Skeleton *skeleton,
+              vertex::SkinErrors &skin_errors, Writer &writer) {
+  writer.String(
+      fmt::format("{}: {}", mesh->mName.C_Str(), material->GetName().C_Str()));
+  writer.Pod(info.buffer_type);
+  writer.Pod(vertex_format);
+  writer.Pod(info.vertex_count);
+  writer.Pod(info.indice_count);
+  const AABB bb{assglm::GetVec(mesh->mAABB.mMin),
+                assglm::GetVec(mesh->mAABB.mMax)};
+  writer.Pod(bb.center_);
+  writer.Pod(bb.extent_);
+  CookMaterial(material, writer);
+
+  const GLuint vertex_count = info.vertex_count;
+  const bool compact = vertex_format == VertexFormat::kCompact;
+  writer.Array(std::span<const glm::vec3>(streams.positions));
+  if (compact && !skeleton) {
+    writer.Array(std::span<const uint32_t>(streams.packed_normals));
+    writer.Array(std::span<const uint32_t>(streams.packed_tangents));
+    writer.Array(std::span<const uint32_t>(streams.packed_tex_coords));
+  } else {
+    writer.Array(std::span<const glm::vec3>(streams.normals));
+    writer.Array(std::span<const glm::vec3>(streams.tangents));
+    writer.Array(std::span<const glm::vec3>(streams.bitangents));
+    writer.Array(std::span<const float>(streams.tex_coords));
+  }
+  writer.Array(std::span<const unsigned int>(streams.indices));
+
+  if (skeleton) {
+    loading::PhaseTimer extraction(loading::Phase::kVertexExtraction);
+    // Assimp's vertex ids
+    vertex::Stream<glm::ivec4> source_bones(vertex_count, glm::ivec4(0));
+    vertex::Stream<glm::vec4> source_weights(vertex_count, glm::vec4(0.0f));
+    vertex::ExtractBoneWeight(mesh, *skeleton, source_bones, source_weights);
+    vertex::Stream<glm::ivec4> bones;
+    vertex::Stream<glm::vec4> weights;
+    vertex::RemapStream(std::span<const glm::ivec4>(source_bones),
+                        streams.remap, 1, bones);
+    vertex::RemapStream(std::span<const glm::vec4>(source_weights),
+                        streams.remap, 1, weights);
+    if (!compact) {
+      writer.Array(std::span<const glm::ivec4>(bones));
+      writer.Array(std::span<const glm::vec4>(weights));
+      extraction.AddBytes(bones.size() * sizeof(glm::ivec4) +
+                          weights.size() * sizeof(glm::vec4));
+      return;
+    }
+
+    vertex::Stream<glm::i16vec4> packed_bones(vertex_count);
+    vertex::Stream<glm::u8vec4> packed_weights(vertex_count);
+    for (GLuint v = 0; v < vertex_count; ++v) {
+      packed_bones[v] = vertex::PackBones(bones[v]);
+      packed_weights[v] = vertex::PackWeights(weights[v]);
+    }
+    vertex::ValidateSkin(bones, weights, packed_bones, packed_weights,
+                         skin_errors);
+    writer.Array(std::span<const glm::i16vec4>(packed_bones));
+    writer.Array(std::span<const glm::u8vec4>(packed_weights));
+    extraction.AddBytes(packed_bones.size() * sizeof(glm::i16vec4) +
+                        packed_weights.size() * sizeof(glm::u8vec4));
+  }
+}
+
+void CookSkeleton(const Skeleton &skeleton, Writer &writer) {
+  writer.Pod(static_cast<uint32_t>(skeleton.bone_map.size()));
+  for (const auto &[name, id] : skeleton.bone_map) {
+    writer.String(name);
+    writer.Pod(id);
+  }
+  writer.Array(std::span<const glm::mat4>(skeleton.bone_to_local));
+  writer.Pod(static_cast<uint32_t>(skeleton.bone_box.size()));
+  for (const auto &[id, box] : skeleton.bone_box) {
+    writer.Pod(id);
+    writer.Pod(box.center_);
+    writer.Pod(box.extent_);
+  }
+  writer.Pod(static_cast<uint32_t>(skeleton.bones_per_model.size()));
+  for (const auto &bones : skeleton.bones_per_model) {
+    writer.Array(std::span<const int>(bones));
+  }
+}
+
+void ParseSkeleton(Reader &reader, Skeleton &skeleton) {
+  const uint32_t bone_count = reader.Count();
+  skeleton = Skeleton{bone_count};
+  for (uint32_t i = 0; i < bone_count; ++i) {
+    std::string name{reader.String()};
+    skeleton.bone_map.try_emplace(std::move(name), reader.Pod<int>());
+  }
+  auto bone_to_local = reader.Array<glm::mat4>();
+  skeleton.bone_to_local.assign(bone_to_local.begin(), bone_to_local.end());
+  const uint32_t box_count = reader.Count();
+  for (uint32_t i = 0; i < box_count; ++i) {
+    const int id = reader.Pod<int>();
+    AABB box;
+    box.center_ = reader.Pod<glm::vec3>();
+    box.extent_ = reader.Pod<glm::vec3>();
+    skeleton.bone_box.try_emplace(id, box);
+  }
+  skeleton.bones_per_model.resize(reader.Count());
+  for (auto &bones : skeleton.bones_per_model) {
+    auto view = reader.Array<int>();
+    bones.assign(view.begin(), view.end());
+  }
+}
+
+// the upload reads vertex_count elements of every stream
+bool IsComplete(const MeshData &mesh) {
+  const size_t count = mesh.vertex_count;
+  const bool skinned = mesh.buffer_type == BufferType::kSkinned;
+  const size_t packed_frame = mesh.HasPackedFrame() ? count : 0;
+  const size_t full_frame = count - packed_frame;
+  const size_t packed_skin = mesh.HasPackedSkin() ? count : 0;
+  const size_t full_skin = skinned ? count - packed_skin : 0;
+  return mesh.positions.size() == count &&
+         mesh.normals.size() == full_frame &&
+         mesh.tangents.size() == full_frame &&
+         mesh.bitangents.size() == full_frame &&
+         mesh.tex_coords.size() == 2 * full_frame &&
+         mesh.packed_normals.size() == packed_frame &&
+         mesh.packed_tangents.size() == packed_frame &&
+         mesh.packed_tex_coords.size() == packed_frame &&
+         mesh.indices.size() == mesh.indice_count &&
+         mesh.bones.size() == full_skin && mesh.weights.size() == full_skin &&
+         mesh.packed_bones.size() == packed_skin &&
+         mesh.packed_weights.size() == packed_skin;
+}
+
+}  // namespace
+
+bool MeshData::HasPackedFrame() const {
+  return vertex_format == VertexFormat::kCompact &&
+         buffer_type == BufferType::kStatic;
+}
+
+bool MeshData::HasPackedSkin() const {
+  return vertex_format == VertexFormat::kCompact &&
+         buffer_type == BufferType::kSkinned;
+}
+
+void Cook(const aiScene *scene, const Key &key, GLuint vertex_format,
+          Blob &blob) {
+  Writer writer(blob);
+  WriteHeader(writer, kMagic, kModelVersion, key);
+  // as requested, the blob is cooked for one format
+  writer.Pod(vertex_format);
+
+  // the skinned models have only the skinned meshes
+  const bool skinned = scene->HasAnimations();
+  const GLuint buffer_type =
+      skinned ? BufferType::kSkinned : BufferType::kStatic;
+  // the skinned meshes pack the skin and keep the full frame
+  const GLuint frame_format = skinned ? VertexFormat::kFull : vertex_format;
+
+  Skeleton skeleton;
+  if (skinned) {
+    unsigned int total_bones = 0;
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+      total_bones += scene->mMeshes[i]->mNumBones;
+    }
+    skeleton = Skeleton{total_bones};
+  }
+
+  MiVector<const aiMesh *> meshes;
+  meshes.reserve(scene->mNumMeshes);
+  for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+    const aiMesh *mesh = scene->mMeshes[i];
+    if (MeshInfo{mesh}.buffer_type != buffer_type) {
+      spdlog::error("{}: Wrong buffer '{}'", __FUNCTION__, mesh->mName.C_Str());
+      continue;
+    }
+    meshes.push_back(mesh);
+  }
+
+  size_t reserve = 0;
+  for (const aiMesh *mesh : meshes) {
+    reserve += mesh->mNumVertices * (4 * sizeof(glm::vec3) + 2 * sizeof(float) +
+                                     sizeof(glm::ivec4) + sizeof(glm::vec4)) +
+               mesh->mNumFaces * 3 * sizeof(unsigned int);
+  }
+  blob.reserve(blob.size() + reserve);
+
+  // the meshes are extracted and optimized in parallel, one huge mesh
+  // doesn't hold the others; the skeleton is shared and its bone ids
+  // follow the order of the meshes, the bones are extracted serially
+  // (CookMesh)
+  MiVector<MeshStreams> streams(meshes.size());
+  {
+    loading::PhaseTimer extraction(loading::Phase::kVertexExtraction);
+    app::task::ParallelFor(
+        meshes.size(),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            ExtractStreams(meshes[i], frame_format, streams[i]);
+          }
+        },
+        1);
+    for (const auto &mesh : streams) {
+      extraction.AddBytes(GetStreamBytes(mesh) +
+                          mesh.indices.size() * sizeof(unsigned int));
+    }
+  }
+
+  // transformed vertices per triangle and per vertex, the whole model
+  size_t triangles = 0;
+  size_t vertices = 0;
+  size_t source = 0;
+  size_t optimized = 0;
+  for (const auto &mesh : streams) {
+    triangles += mesh.indices.size() / 3;
+    vertices += mesh.positions.size();
+    source += mesh.source.transforms;
+    optimized += mesh.optimized.transforms;
+  }
+  if (triangles && vertices) {
+    spdlog::info("{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                 __FUNCTION__, static_cast<float>(source) / triangles,
+                 static_cast<float>(optimized) / triangles,
+                 static_cast<float>(source) / vertices,
+                 static_cast<float>(optimized) / vertices);
+  }
+
+  vertex::SkinErrors skin_errors;
+  writer.Pod(static_cast<uint32_t>(meshes.size()));
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    const aiMesh *mesh = meshes[i];
+    const aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+    CookMesh(mesh, material, MeshInfo{mesh}, vertex_format, streams[i],
+             skinned ? &skeleton : nullptr, skin_errors, writer);
+  }
+  if (skinned && vertex_format == VertexFormat::kCompact) {
+    // bone ids above kMaxPackedBones are clamped
+    if (skin_errors.bones || skin_errors.sums) {
+      spdlog::error("{}: Packed skin, {} bones and {} sums differ",
+                    __FUNCTION__, skin_errors.bones, skin_errors.sums);
+    }
+    spdlog::info("{}: Packed skin weights, max error {:.4f}", __FUNCTION__,
+                 skin_errors.max_weight);
+  }
+
+  // load animations when Skeleton processed
+  MiVector<Animation> animations;
+  animations.reserve(scene->mNumAnimations);
+  for (unsigned int i = 0; i < scene->mNumAnimations; ++i) {
+    animations.emplace_back(scene->mAnimations[i], scene->mRootNode, skeleton);
+  }
+
+  CookSkeleton(skeleton, writer);
+  writer.Pod(static_cast<uint32_t>(animations.size()));
+  for (const auto &animation : animations) {
+    animation.Write(writer);
+  }
+}
+
+bool Parse(std::span<const char> blob, const Key &key, GLuint vertex_format,
+           ModelData &model) {
+  Reader reader(blob);
+  if (!ReadHeader(reader, kMagic, kModelVersion, key)) return false;
+  if (reader.Pod<GLuint>() != vertex_format) return false;
+
+  model.meshes.resize(reader.Count());
+  for (auto &mesh : model.meshes) {
+    mesh.name = reader.String();
+    mesh.buffer_type = reader.Pod<GLuint>();
+    mesh.vertex_format = reader.Pod<GLuint>();
+    mesh.vertex_count = reader.Pod<GLuint>();
+    mesh.indice_count = reader.Pod<GLuint>();
+    mesh.bb.center_ = reader.Pod<glm::vec3>();
+    mesh.bb.extent_ = reader.Pod<glm::vec3>();
+
+    auto &material = mesh.material;
+    material.name = reader.String();
+    material.diffuse_color_alpha_threshold = reader.Pod<glm::vec4>();
+    material.emission_color_emission_intensity = reader.Pod<glm::vec4>();
+    material.roughness = reader.Pod<float>();
+    material.metallic = reader.Pod<float>();
+    for (auto &texture : material.textures) {
+      texture = reader.String();
+    }
+
+    mesh.positions = reader.Array<glm::vec3>();
+    if (mesh.HasPackedFrame()) {
+      mesh.packed_normals = reader.Array<uint32_t>();
+      mesh.packed_tangents = reader.Array<uint32_t>();
+      mesh.packed_tex_coords = reader.Array<uint32_t>();
+    } else {
+      mesh.normals = reader.Array<glm::vec3>();
+      mesh.tangents = reader.Array<glm::vec3>();
+      mesh.bitangents = reader.Array<glm::vec3>();
+      mesh.tex_coords = reader.Array<float>();
+    }
+    mesh.indices = reader.Array<unsigned int>();
+    if (mesh.HasPackedSkin()) {
+      mesh.packed_bones = reader.Array<glm::i16vec4>();
+      mesh.packed_weights = reader.Array<glm::u8vec4>();
+    } else if (mesh.buffer_type == BufferType::kSkinned) {
+      mesh.bones = reader.Array<glm::ivec4>();
+      mesh.weights = reader.Array<glm::vec4>();
+    }
+    if (!IsComplete(mesh)) reader.Fail();
+  }
+
+  ParseSkeleton(reader, model.skeleton);
+  const uint32_t animation_count = reader.Count();
+  model.animations.reserve(animation_count);
+  for (uint32_t i = 0; i < animation_count && reader.IsOk(); ++i) {
+    model.animations.emplace_back(reader);
+  }
+
+  if (!reader.IsOk() || !reader.IsEnd()) {
+    spdlog::error("{}: Corrupted model cache", __FUNCTION__);
+    model = ModelData{};
+    return false;
+  }
+  return true;
+}
+
+}  // namespace cooked
@@ -0,0 +1,89 @@
+#pragma once
+
+// deps
+#include <glm/gtc/type_precision.hpp>
+// global
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+// local
+#include "assets/animation.h"
+#include "assets/cooked_blob.h"
+#include "assets/texture.h"
+#include "global.h"
+#include "math/collision_types.h"
+// fwd
+struct aiScene;
+
+// cooked models, the final vertex streams, materials, skeleton and
+// animations (with the keyframe boxes) in one binary blob per model
+// cold start: Assimp -> Cook() -> Save(), warm start: the mapped file
+// resources/cache/<source path>.model or .compact.model (GetCachePath)
+// both are parsed to views and the streams are uploaded from the blob
+namespace cooked {
+
+// bump on any change of the layout or of the cooking
+inline constexpr uint32_t kModelVersion = 4;
+
+struct MaterialData {
+  std::string_view name;
+  glm::vec4 diffuse_color_alpha_threshold;
+  glm::vec4 emission_color_emission_intensity;
+  float roughness;
+  float metallic;
+  // as exported, relative to resources/, empty if none
+  std::array<std::string_view, TextureType::kTotal> textures;
+};
+
+// kBones and kWeights only for the skinned meshes
+// kCompact: the packed streams instead of the normals, the tangents, the
+// bitangents and the tex coords (static) or the bones and weights (skinned)
+struct MeshData {
+  std::string_view name;
+  // BufferType
+  GLuint buffer_type;
+  // VertexFormat
+  GLuint vertex_format;
+  GLuint vertex_count;
+  GLuint indice_count;
+  AABB bb;
+  MaterialData material;
+  std::span<const glm::vec3> positions;
+  std::span<const glm::vec3> normals;
+  std::span<const glm::vec3> tangents;
+  std::span<const glm::vec3> bitangents;
+  // 2 per vertex
+  std::span<const float> tex_coords;
+  std::span<const uint32_t> packed_normals;
+  std::span<const uint32_t> packed_tangents;
+  std::span<const uint32_t> packed_tex_coords;
+  std::span<const glm::ivec4> bones;
+  std::span<const glm::vec4> weights;
+  std::span<const glm::i16vec4> packed_bones;
+  std::span<const glm::u8vec4> packed_weights;
+  std::span<const unsigned int> indices;
+
+  bool HasPackedFrame() const;
+  bool HasPackedSkin() const;
+};
+
+// the meshes are views into the blob, it must outlive them
+// the skeleton and the animations are owned (moved to the Model)
+struct ModelData {
+  MiVector<MeshData> meshes;
+  Skeleton skeleton;
+  MiVector<Animation> animations;
+};
+
+// CPU only, extracts the streams and builds the skeleton and the animations
+// the triangles and the vertices are reordered (assets/vertex_cache.h)
+// vertex_format (VertexFormat) of all the meshes
+void Cook(const aiScene *scene, const Key &key, GLuint vertex_format,
+          Blob &blob);
+// false if the blob is not of this version, of another key or format
+// import_flags of the key are Assimp's post-processing flags
+bool Parse(std::span<const char> blob, const Key &key, GLuint vertex_format,
+           ModelData &model);
+
+}  // namespace cooked
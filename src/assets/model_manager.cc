@@ -1,34 +1,163 @@
 #include "model_manager.h"
 
 // deps
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/IOStream.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <spdlog/spdlog.h>
+// global
+#include <algorithm>
+#include <optional>
 // local
 #include "app/parameters.h"
+#include "assets/loading_report.h"
+#include "assets/model_cache.h"
 #include "ui/win_resources.h"
+#include "utils/metrics.h"
 #include "utils/profiling.h"
 
+namespace {
+
+metrics::Counter gCacheHits{"models.cache_hits"};
+metrics::Counter gCacheMisses{"models.cache_misses"};
+
+// the file reads inside Importer::ReadFile(), the rest is the import
+// one per importer, used by one worker at a time
+class TimedIOSystem : public Assimp::DefaultIOSystem {
+ public:
+  Assimp::IOStream *Open(const char *file, const char *mode) override;
+  void Close(Assimp::IOStream *stream) override { delete stream; }
+
+  void Reset() {
+    read_ms_ = 0.0f;
+    read_bytes_ = 0;
+  }
+
+ public:
+  float read_ms_{0.0f};
+  uint64_t read_bytes_{0};
+};
+
+class TimedIOStream : public Assimp::IOStream {
+ public:
+  TimedIOStream(Assimp::IOStream *stream, TimedIOSystem &system)
+      : stream_(stream), system_(system) {}
+  ~TimedIOStream() override { delete stream_; }
+
+  size_t Read(void *buffer, size_t size, size_t count) override {
+    prof::Counter read;
+    size_t result = stream_->Read(buffer, size, count);
+    system_.read_ms_ += read.GetElapsed<prof::fms>();
+    system_.read_bytes_ += result * size;
+    return result;
+  }
+  size_t Write(const void *buffer, size_t size, size_t count) override {
+    return stream_->Write(buffer, size, count);
+  }
+  aiReturn Seek(size_t offset, aiOrigin origin) override {
+    return stream_->Seek(offset, origin);
+  }
+  size_t Tell() const override { return stream_->Tell(); }
+  size_t FileSize() const override { return stream_->FileSize(); }
+  void Flush() override { stream_->Flush(); }
+
+ private:
+  Assimp::IOStream *stream_;
+  TimedIOSystem &system_;
+};
+
+Assimp::IOStream *TimedIOSystem::Open(const char *file, const char *mode) {
+  Assimp::IOStream *stream = DefaultIOSystem::Open(file, mode);
+  if (!stream) return nullptr;
+  return new TimedIOStream(stream, *this);
+}
+
+// VertexFormat of all the meshes
+GLuint GetVertexFormat() {
+  return app::cpu.compact_vertices ? VertexFormat::kCompact
+                                   : VertexFormat::kFull;
+}
+
+// the order of the streams of Mesh::Upload
+gl::Attributes GetStaticAttributes(GLuint vertex_format) {
+  if (vertex_format == VertexFormat::kCompact) {
+    return {
+        &kPositionAttr,       //
+        &kPackedNormalAttr,   //
+        &kPackedTangentAttr,  //
+        &kHalfTexCoordsAttr   //
+    };
+  }
+  return {
+      &kPositionAttr,   //
+      &kNormalAttr,     //
+      &kTangentAttr,    //
+      &kBitangentAttr,  //
+      &kTexCoordsAttr   //
+  };
+}
+
+gl::Attributes GetSkinnedAttributes(GLuint vertex_format) {
+  if (vertex_format == VertexFormat::kCompact) {
+    return {
+        &kPositionAttr,       //
+        &kNormalAttr,         //
+        &kTangentAttr,        //
+        &kBitangentAttr,      //
+        &kTexCoordsAttr,      //
+        &kPackedBonesAttr,    //
+        &kPackedWeightsAttr,  //
+    };
+  }
+  return {
+      &kPositionAttr,   //
+      &kNormalAttr,     //
+      &kTangentAttr,    //
+      &kBitangentAttr,  //
+      &kTexCoordsAttr,  //
+      &kBonesAttr,      //
+      &kWeightsAttr,    //
+  };
+}
+
+// the memory of count full vertices (and indices) in the compact ones
+GLuint ScaleToFullSize(GLuint count, const gl::Attributes &full,
+                       const gl::Attributes &attrs) {
+  return static_cast<GLuint>(static_cast<uint64_t>(count) *
+                             gl::GetVertexSize(full) /
+                             gl::GetVertexSize(attrs));
+}
+
+// the scopes are after the last co_await, they stay on one thread
+app::coro::Task<void> PrefetchTextureMt(
+    TextureManager &textures, std::string path, TextureType::Enum type,
+    loading::Asset asset, std::shared_ptr<SmartTexture> &texture) {
+  co_await app::coro::SwitchToGlWorker();
+  // another model loads it, the worker is free meanwhile
+  co_await textures.WaitInFlightMt(path);
+  // decode and upload report to the model
+  loading::Scope scope(asset);
+  texture = textures.CreateTextureMt(path, type, false);
+}
+
+app::coro::Task<void> CreateModelMt(const std::string &name,
+                                    cooked::ModelData &data,
+                                    ModelManager &models, loading::Asset asset,
+                                    std::optional<Model> &model) {
+  co_await app::coro::SwitchToGlWorker();
+  loading::Scope scope(asset);
+  model.emplace(name, data, models);
+}
+
+}  // namespace
+
 ModelManager::ModelManager(TextureManager &textures, ui::WinResources &ui)
     : event::Base<ModelManager>(&ModelManager::InitEvents, this),
       textures_(textures),
       ui_(ui),
-      mesh_static_({
-          &kPositionAttr,   //
-          &kNormalAttr,     //
-          &kTangentAttr,    //
-          &kBitangentAttr,  //
-          &kTexCoordsAttr   //
-      }),
-      mesh_skinned_({
-          &kPositionAttr,   //
-          &kNormalAttr,     //
-          &kTangentAttr,    //
-          &kBitangentAttr,  //
-          &kTexCoordsAttr,  //
-          &kBonesAttr,      //
-          &kWeightsAttr,    //
-      }) {
+      mesh_static_(GetStaticAttributes(GetVertexFormat())),
+      mesh_skinned_(GetSkinnedAttributes(GetVertexFormat())) {
   indirect_cmd_storage_.BindBuffer(GL_SHADER_STORAGE_BUFFER,
                                    ShaderStorageBinding::kIndirectCmdStorage);
   indirect_cmd_storage_.SetStorage();
@@ -39,14 +168,29 @@ ModelManager::ModelManager(TextureManager &textures, ui::WinResources &ui)
                         ShaderStorageBinding::kMaterials);
   materials_.SetStorage();
 
-  mesh_static_.SetStorage(global::kMaxVerticesPerMemBlock,
-                          global::kMaxIndicesPerMemBlock);
-  mesh_skinned_.SetStorage(global::kMaxVerticesPerMemBlock,
-                           global::kMaxIndicesPerMemBlock);
+  // the memory of kMaxVerticesPerMemBlock full vertices, the compact ones
+  // fit 56 / 24 (static) and 88 / 68 (skinned) times more, the indices
+  // follow
+  const auto full_static = GetStaticAttributes(VertexFormat::kFull);
+  const auto full_skinned = GetSkinnedAttributes(VertexFormat::kFull);
+  const auto &static_attrs = mesh_static_.GetAttrs();
+  const auto &skinned_attrs = mesh_skinned_.GetAttrs();
+  mesh_static_.SetStorage(
+      ScaleToFullSize(global::kMaxVerticesPerMemBlock, full_static,
+                      static_attrs),
+      ScaleToFullSize(global::kMaxIndicesPerMemBlock, full_static,
+                      static_attrs));
+  mesh_skinned_.SetStorage(
+      ScaleToFullSize(global::kMaxVerticesPerMemBlock, full_skinned,
+                      skinned_attrs),
+      ScaleToFullSize(global::kMaxIndicesPerMemBlock, full_skinned,
+                      skinned_attrs));
 
   workers_.reserve(app::cpu.task_threads);
   for (unsigned int i = 0; i < app::cpu.task_threads; ++i) {
     workers_.push_back(std::make_unique<Assimp::Importer>());
+    // owned by the importer
+    workers_.back()->SetIOHandler(new TimedIOSystem);
   }
 
   // prealloction
@@ -74,8 +218,10 @@ void ModelManager::InitEvents() {
   });
 }
 
-void ModelManager::LoadModelMt(const fs::path &path,
-                               unsigned int thread_id) noexcept {
+app::coro::Task<void> ModelManager::LoadModelMt(fs::path path) noexcept {
+  constexpr auto kLoading = app::task::Priority::kBackground;
+  // Assimp part is CPU-only, any worker
+  int thread_id = co_await app::coro::SwitchToWorker{kLoading};
   auto &importer = workers_[thread_id];
   // don't use those flags:
   // broke meshes
@@ -100,42 +246,155 @@ void ModelManager::LoadModelMt(const fs::path &path,
   std::string name = path.stem().string();
 
   ui_.loading_info_.models[thread_id] = name.c_str();
+  loading::Asset asset = loading::Begin(name, "model");
 
+  // warm start: the mapped cache, cold start: Assimp and the cooked blob
+  // the streams are uploaded from one of them
   prof::Counter read;
-  const aiScene *scene = importer->ReadFile(filepath, assimp_flags);
-  read.End();
+  cooked::Key key;
+  cooked::ModelData data;
+  files::MappedFile cache;
+  cooked::Blob blob;
+  const GLuint vertex_format = GetVertexFormat();
+  const fs::path cache_path = cooked::GetCachePath(
+      path, vertex_format == VertexFormat::kCompact ? ".compact.model"
+                                                    : ".model");
+  if (app::cpu.model_cache) {
+    files::MappedFile source;
+    if (source.Open(path)) {
+      key = cooked::MakeKey(source.GetData(), assimp_flags);
+    }
+    if (!cache.Open(cache_path) ||
+        !cooked::Parse(cache.GetData(), key, vertex_format, data)) {
+      cache.Close();
+    }
+    loading::Add(asset, loading::Phase::kFileRead, read.GetElapsed<prof::fms>(),
+                 source.GetData().size() + cache.GetData().size());
+  }
 
-  if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
-      !scene->mRootNode) {
-    spdlog::error("{}: Assimp_Importer {}", __FUNCTION__,
-                  importer->GetErrorString());
-    return;
+  const bool cached = cache.IsOpen();
+  if (cached) {
+    gCacheHits.Add();
+  } else {
+    // see the constructor
+    auto *io = static_cast<TimedIOSystem *>(importer->GetIOHandler());
+    io->Reset();
+    prof::Counter assimp;
+    const aiScene *scene = nullptr;
+    {
+      prof::Zone zone("Assimp::ReadFile");
+      scene = importer->ReadFile(filepath, assimp_flags);
+    }
+    const float import_ms = assimp.GetElapsed<prof::fms>();
+    loading::Add(asset, loading::Phase::kFileRead, io->read_ms_,
+                 io->read_bytes_);
+    loading::Add(asset, loading::Phase::kImport,
+                 std::max(import_ms - io->read_ms_, 0.0f));
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
+        !scene->mRootNode) {
+      spdlog::error("{}: Assimp_Importer {}", __FUNCTION__,
+                    importer->GetErrorString());
+      ui_.loading_info_.models[thread_id] = global::kEmptyName;
+      loading::End(asset);
+      co_return;
+    }
+
+    {
+      // vertex extraction reports to the model
+      loading::Scope scope(asset);
+      cooked::Cook(scene, key, vertex_format, blob);
+    }
+    importer->FreeScene();
+    gCacheMisses.Add();
+    // a blob that can't be read back is not saved
+    if (!cooked::Parse(blob, key, vertex_format, data)) {
+      spdlog::error("{}: Cooked model is invalid '{}'", __FUNCTION__, name);
+      ui_.loading_info_.models[thread_id] = global::kEmptyName;
+      loading::End(asset);
+      co_return;
+    }
+    if (app::cpu.model_cache) cooked::Save(cache_path, blob);
   }
+  read.End();
+  ui_.loading_info_.models[thread_id] = global::kEmptyName;
 
+  // vertex buffers and textures need OpenGL context
+  // every texture is its own task: a model with many textures spreads over
+  // all GL workers instead of one
+  // the meshes go after them and find them loaded, no GL worker blocks on
+  // a texture in flight (TextureManager loads each path once)
   prof::Counter upload;
+  std::optional<Model> created;
+  MiVector<std::shared_ptr<SmartTexture>> prefetched;
+  {
+    MiVector<std::pair<std::string_view, TextureType::Enum>> unique;
+    for (const auto &mesh : data.meshes) {
+      const auto &paths = mesh.material.textures;
+      for (GLuint i = 0; i < TextureType::kTotal; ++i) {
+        const std::pair texture{paths[i], static_cast<TextureType::Enum>(i)};
+        if (paths[i].empty() ||
+            std::find(unique.begin(), unique.end(), texture) != unique.end()) {
+          continue;
+        }
+        unique.push_back(texture);
+      }
+    }
 
-  Model model{name, scene, *this};
+    // the tasks write to their slots, no reallocation
+    prefetched.resize(unique.size());
+    MiVector<app::coro::Task<void>> tasks;
+    tasks.reserve(unique.size());
+    for (size_t i = 0; i < unique.size(); ++i) {
+      tasks.push_back(PrefetchTextureMt(textures_,
+                                        GetTexturePath(unique[i].first),
+                                        unique[i].second, asset,
+                                        prefetched[i]));
+    }
+    co_await app::coro::WhenAll(tasks);
+  }
+  co_await CreateModelMt(name, data, *this, asset, created);
+  Model &model = *created;
+  // the streams are in the buffers, the meshes hold their textures
+  data.meshes.clear();
+  cache.Close();
+  blob = {};
+  prefetched.clear();
+  upload.End();
+
+  // one hop to the main context for all textures of the model
+  prof::Counter handles;
+  co_await app::coro::SwitchToMainThread();
+  for (auto &mesh : model.meshes_) {
+    for (const auto &texture : mesh.GetTextures()) {
+      if (texture) textures_.MakeResidentMainThread(*texture);
+    }
+    mesh.UpdateMaterialTextureHandlers();
+  }
+  loading::Add(asset, loading::Phase::kMainThreadWait,
+               handles.GetElapsed<prof::fms>());
+  co_await app::coro::SwitchToWorker{kLoading};
 
   {
     std::scoped_lock lock(mutex_);
     auto [it, res] = models_.try_emplace(model.GetName(), std::move(model));
-    auto &created = it->second;
-    for (auto &mesh : created.meshes_) {
+    auto &stored = it->second;
+    for (auto &mesh : stored.meshes_) {
       queue_meshes_.push_back(&mesh);
     }
-    ui_.table_model_.AddRow(created.GetId(), created.GetName().c_str());
+    ui_.table_model_.AddRow(stored.GetId(), stored.GetName().c_str());
   }
-  upload.End();
-
-  ui_.loading_info_.models[thread_id] = global::kEmptyName;
+  loading::End(asset);
 
   // profiling (i7-6700k, RTX 3070 Ti)
-  // assimp part, most time vertices(join)
+  // assimp part, most time vertices(join), the cache skips it
   // engine part, ~95% of time images/textures
+  // thread_id is the worker of the import, the rest hopped across threads
   spdlog::info(
-      "Thread {}: {}, Assimp: {:.3f}s, Textures/Upload: {:.3f}s, Total: "
-      "{:.3f}s",
-      thread_id, name, read.GetTime<prof::fsec>(), upload.GetTime<prof::fsec>(),
+      "Import thread {}: {}, {}: {:.3f}s, Textures/Upload: {:.3f}s, "
+      "Total: {:.3f}s",
+      thread_id, name, cached ? "Cache" : "Assimp",
+      read.GetTime<prof::fsec>(), upload.GetTime<prof::fsec>(),
       read.GetElapsed<prof::fsec>());
 }
 
@@ -3,6 +3,7 @@
 // deps
 #include <assimp/Importer.hpp>
 // local
+#include "app/coro.h"
 #include "assets/model.h"
 #include "assets/texture_manager.h"
 #include "events.h"
@@ -11,6 +12,7 @@
 #include "math/collision_types.h"
 #include "opengl/buffer_storage.h"
 #include "opengl/vertex_buffers.h"
+#include "utils/profiling.h"
 // fwd
 namespace ui {
 class WinResources;
@@ -60,8 +62,10 @@ class ModelManager : public event::Base<ModelManager> {
   // to invoke compute shader by Renderer
   bool build_indirect_cmd_{false};
 
-  // each Model is created in the independent thread
-  void LoadModelMt(const fs::path &path, unsigned int thread_id) noexcept;
+  // each Model is created in the independent task
+  // suspends (doesn't block a worker) while the main thread makes
+  // the model's textures resident
+  app::coro::Task<void> LoadModelMt(fs::path path) noexcept;
   Model *FindModelMt(const std::string &name);
 
   const MeshCounts &GetMeshCounts() const;
@@ -81,7 +85,7 @@ class ModelManager : public event::Base<ModelManager> {
   gl::CountedBuffer<gpu::StorageStaticBoxes> static_boxes_{"StaticBoxes"};
   gl::CountedBuffer<gpu::StorageMaterials> materials_{"Materials"};
 
-  mutable std::mutex mutex_;
+  mutable prof::Mutex mutex_{"ModelManager"};
   gl::Sync sync_;
 
   MeshCounts mesh_counts_{};
@@ -1,2 +1,9 @@
+// local
+#include "mem_info.h"
+
+// decoded images are the biggest part of the loading peak
+#define STBI_MALLOC(sz) mem::Allocate(mem::Tag::kAssets, sz)
+#define STBI_REALLOC(p, newsz) mem::Reallocate(mem::Tag::kAssets, p, newsz)
+#define STBI_FREE(p) mem::Free(mem::Tag::kAssets, p)
 #define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
\ No newline at end of file
+#include "stb_image.h"
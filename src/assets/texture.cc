@@ -4,8 +4,11 @@
 #include <spdlog/spdlog.h>
 #include <stb_image.h>
 // local
+#include "assets/loading_report.h"
+#include "assets/texture_cache.h"
 #include "assets/texture_manager.h"
 #include "options.h"
+#include "utils/profiling.h"
 
 GLsizei GetMipMapLevel(int width, int height) {
   GLsizei level = 1;
@@ -28,8 +31,12 @@ GLsizei GetMipMapLevel(int width, int height) {
 };
 
 Image::Image(const std::string &path) {
+  prof::Zone zone("Image Decode");
+  // stb reads the file itself, the read is a part of the decode
+  loading::PhaseTimer decode(loading::Phase::kTextureDecode);
   data = stbi_load(path.c_str(), &width, &height, &num_of_channels, 0);
   if (data) {
+    decode.AddBytes(static_cast<uint64_t>(width) * height * num_of_channels);
     success = true;
   } else {
     spdlog::error("{}: Failed to load '{}', reason '{}'", __FUNCTION__, path,
@@ -46,8 +53,12 @@ Image::~Image() {
 }
 
 ImageHdr::ImageHdr(const std::string &path) {
+  prof::Zone zone("ImageHdr Decode");
+  loading::PhaseTimer decode(loading::Phase::kTextureDecode);
   data = stbi_loadf(path.c_str(), &width, &height, &num_of_channels, 0);
   if (data) {
+    decode.AddBytes(static_cast<uint64_t>(width) * height * num_of_channels *
+                    sizeof(float));
     success = true;
   } else {
     spdlog::error("{}: Failed to load '{}', reason '{}'", __FUNCTION__, path,
@@ -63,7 +74,7 @@ ImageHdr::~ImageHdr() {
   }
 }
 
-Texture::Texture(const Image &img, TextureType::Enum type) {
+bool IsColorTexture(TextureType::Enum type) {
   static constexpr bool kGammaCorrection[TextureType::kTotal]{
       true,   // color
       false,  // linear
@@ -72,12 +83,24 @@ Texture::Texture(const Image &img, TextureType::Enum type) {
       false,  // linear
       false,  // linear
   };
-  bool gamma_correction = kGammaCorrection[type];
+  return kGammaCorrection[type];
+}
+
+namespace {
+
+struct Format {
+  GLenum internal_format;
+  GLenum data_format;
+  GLint wrap_method;
+};
+
+Format GetFormat(int num_of_channels, TextureType::Enum type) {
+  bool gamma_correction = IsColorTexture(type);
   // setup OpenGL texture object
   GLenum internal_format = GL_RGB8;
   GLenum data_format = GL_RGB;
   GLint wrap_method = GL_REPEAT;
-  switch (img.num_of_channels) {
+  switch (num_of_channels) {
     case 1:
       internal_format = GL_R8;
       data_format = GL_RED;
@@ -102,16 +125,78 @@ Texture::Texture(const Image &img, TextureType::Enum type) {
     default:
       break;
   }
+  return Format{internal_format, data_format, wrap_method};
+}
+
+GLenum GetCompressedFormat(bc::Format::Enum format, TextureType::Enum type) {
+  const bool gamma_correction = IsColorTexture(type);
+  switch (format) {
+    case bc::Format::kBC1:
+      return gamma_correction ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+                              : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case bc::Format::kBC3:
+      return gamma_correction ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                              : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case bc::Format::kBC4:
+      return GL_COMPRESSED_RED_RGTC1;
+    case bc::Format::kBC5:
+      return GL_COMPRESSED_RG_RGTC2;
+    case bc::Format::kBC7:
+      return gamma_correction ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+                              : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+      return GL_NONE;
+  }
+}
+
+}  // namespace
+
+Texture::Texture(const Image &img, TextureType::Enum type) {
+  const Format format = GetFormat(img.num_of_channels, type);
 
   // storage part
+  prof::Zone zone("Texture Upload");
   GLsizei levels = GetMipMapLevel(img.width, img.height);
-  tbo_.SetStorage2D(levels, internal_format, img.width, img.height);
-  tbo_.SubImage2D(img.width, img.height, data_format, GL_UNSIGNED_BYTE,
+  tbo_.SetStorage2D(levels, format.internal_format, img.width, img.height);
+  tbo_.SubImage2D(img.width, img.height, format.data_format, GL_UNSIGNED_BYTE,
                   img.data);
   tbo_.GenerateMipMap();
   // sampler part
   // model's textures will be overwritten by bindless texture sampler
-  tbo_.SetWrap2D(wrap_method);
+  tbo_.SetWrap2D(format.wrap_method);
+  tbo_.SetFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+  tbo_.SetAnisotropy(16.0f);
+  tbo_.SetLoadBias(0.0f);
+}
+
+Texture::Texture(const cooked::TextureData &data, TextureType::Enum type) {
+  const Format format = GetFormat(data.num_of_channels, type);
+
+  // storage part
+  prof::Zone zone("Texture Upload");
+  const auto levels = static_cast<GLsizei>(data.levels.size());
+  if (data.format == bc::Format::kNone) {
+    tbo_.SetStorage2D(levels, format.internal_format, data.width, data.height);
+    for (GLsizei i = 0; i < levels; ++i) {
+      const auto &level = data.levels[i];
+      tbo_.SubImage2D(i, 0, 0, level.width, level.height, format.data_format,
+                      GL_UNSIGNED_BYTE, level.pixels.data());
+    }
+  } else {
+    // the blocks as they are, the partial ones are whole
+    const GLenum internal_format = GetCompressedFormat(data.format, type);
+    tbo_.SetStorage2D(levels, internal_format, data.width, data.height);
+    for (GLsizei i = 0; i < levels; ++i) {
+      const auto &level = data.levels[i];
+      tbo_.CompressedSubImage2D(i, 0, 0, level.width, level.height,
+                                internal_format,
+                                static_cast<GLsizei>(level.pixels.size()),
+                                level.pixels.data());
+    }
+  }
+  // sampler part
+  // model's textures will be overwritten by bindless texture sampler
+  tbo_.SetWrap2D(format.wrap_method);
   tbo_.SetFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
   tbo_.SetAnisotropy(16.0f);
   tbo_.SetLoadBias(0.0f);
@@ -136,13 +221,21 @@ SmartTexture::SmartTexture(const Image &img, TextureType::Enum type,
                            TextureManager &manager)
     : Texture(img, type), id_(id::GenId(id::kTexture)), manager_(manager) {}
 
-SmartTexture::~SmartTexture() { manager_.RemoveTextureMt(id_, handler_); }
+SmartTexture::SmartTexture(const cooked::TextureData &data,
+                           TextureType::Enum type, TextureManager &manager)
+    : Texture(data, type), id_(id::GenId(id::kTexture)), manager_(manager) {}
+
+SmartTexture::~SmartTexture() { manager_.RemoveTextureMt(id_, GetHandler()); }
 
 id::Texture SmartTexture::GetId() const { return id_; }
 
-GLuint64 SmartTexture::GetHandler() const { return handler_; }
+GLuint64 SmartTexture::GetHandler() const {
+  return handler_.load(std::memory_order_acquire);
+}
 
-void SmartTexture::SetHandler(GLuint64 handler) { handler_ = handler; }
+void SmartTexture::SetHandler(GLuint64 handler) {
+  handler_.store(handler, std::memory_order_release);
+}
 
 EnvTexture::EnvTexture() : id_(id::GenId(id::kEnvTexture)) {
   environment_tbo_.SetStorage2D(opt::lighting.prefilter_max_level, GL_RGB16F,
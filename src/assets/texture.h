@@ -1,6 +1,7 @@
 #pragma once
 
 // global
+#include <atomic>
 #include <string>
 // local
 #include "global.h"
@@ -8,6 +9,9 @@
 #include "opengl/texture.h"
 // fwd
 class TextureManager;
+namespace cooked {
+struct TextureData;
+}  // namespace cooked
 
 GLsizei GetMipMapLevel(int width, int height);
 
@@ -51,10 +55,16 @@ struct TextureType {
   };
 };
 
+// colors are sRGB (gamma corrected), the rest is linear
+bool IsColorTexture(TextureType::Enum type);
+
 // simple 2D texture
 class Texture {
  public:
   Texture(const Image &img, TextureType::Enum type);
+  // all levels from the CPU (assets/texture_cache.h), no GenerateMipMap()
+  // uncompressed or BCn blocks
+  Texture(const cooked::TextureData &data, TextureType::Enum type);
   // linear space, no gamma correction
   Texture(const ImageHdr &img);
 
@@ -69,6 +79,8 @@ class SmartTexture : public Texture {
  public:
   SmartTexture(const Image &img, TextureType::Enum type,
                TextureManager &manager);
+  SmartTexture(const cooked::TextureData &data, TextureType::Enum type,
+               TextureManager &manager);
   ~SmartTexture();
 
  public:
@@ -78,7 +90,8 @@ class SmartTexture : public Texture {
 
  private:
   id::Texture id_{0};
-  GLuint64 handler_{0};
+  // written on the main thread, checked by the loaders on the workers
+  std::atomic<GLuint64> handler_{0};
   // the destructor deletes the record
   TextureManager &manager_;
 };
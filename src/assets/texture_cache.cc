@@ -0,0 +1,279 @@
+#include "texture_cache.h"
+
+// deps
+#include <spdlog/spdlog.h>
+// global
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace cooked {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x544B4A2E;  // ".JKT"
+// linear [0, 1] to sRGB, fine enough for the darkest values
+constexpr int kSrgbSteps = 1 << 16;
+
+struct SrgbTables {
+  std::array<float, 256> to_linear;
+  // alpha and the linear channels, v / 255
+  std::array<float, 256> identity;
+  MiVector<uint8_t> to_srgb;
+};
+
+const SrgbTables &GetSrgbTables() {
+  static const SrgbTables tables = []() {
+    SrgbTables result;
+    for (int i = 0; i < 256; ++i) {
+      const float c = i / 255.0f;
+      result.to_linear[i] = (c <= 0.04045f)
+                                ? c / 12.92f
+                                : std::pow((c + 0.055f) / 1.055f, 2.4f);
+      result.identity[i] = c;
+    }
+    result.to_srgb.resize(kSrgbSteps);
+    for (int i = 0; i < kSrgbSteps; ++i) {
+      const float l = static_cast<float>(i) / (kSrgbSteps - 1);
+      const float c = (l <= 0.0031308f)
+                          ? l * 12.92f
+                          : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+      result.to_srgb[i] = static_cast<uint8_t>(std::lround(c * 255.0f));
+    }
+    return result;
+  }();
+  return tables;
+}
+
+GLsizei GetLevelCount(GLsizei width, GLsizei height) {
+  GLsizei levels = 1;
+  for (GLsizei size = std::max(width, height); size > 1; size /= 2) {
+    ++levels;
+  }
+  return levels;
+}
+
+// the rows of the source are decoded to floats, summed vertically and then
+// horizontally, SSE for the vertical pass and for the 4 channels
+void Downsample(const uint8_t *src, GLsizei src_width, GLsizei src_height,
+                uint8_t *dst, GLsizei dst_width, GLsizei dst_height,
+                int channels, bool srgb) {
+  const auto &tables = GetSrgbTables();
+  const float *decode[4]{};
+  const uint8_t *encode[4]{};
+  float scale[4]{};
+  for (int k = 0; k < channels; ++k) {
+    const bool color = srgb && k < 3;
+    decode[k] = color ? tables.to_linear.data() : tables.identity.data();
+    encode[k] = color ? tables.to_srgb.data() : nullptr;
+    // the average of the 4 texels to the index (color) or to the value
+    scale[k] = 0.25f * (color ? kSrgbSteps - 1 : 255);
+  }
+
+  const size_t src_pitch = GetPitch(src_width, channels);
+  const size_t dst_pitch = GetPitch(dst_width, channels);
+  const size_t row = static_cast<size_t>(src_width) * channels;
+  MiVector<float> sum(row);
+  MiVector<float> second(row);
+
+  for (GLsizei y = 0; y < dst_height; ++y) {
+    const uint8_t *row0 = src + 2 * y * src_pitch;
+    const uint8_t *row1 =
+        src + std::min(2 * y + 1, src_height - 1) * src_pitch;
+    for (size_t i = 0; i < row; i += channels) {
+      for (int k = 0; k < channels; ++k) {
+        sum[i + k] = decode[k][row0[i + k]];
+        second[i + k] = decode[k][row1[i + k]];
+      }
+    }
+    size_t i = 0;
+#if defined(_M_X64) || defined(__x86_64__)
+    for (; i + 4 <= row; i += 4) {
+      _mm_storeu_ps(&sum[i], _mm_add_ps(_mm_loadu_ps(&sum[i]),
+                                        _mm_loadu_ps(&second[i])));
+    }
+#endif
+    for (; i < row; ++i) {
+      sum[i] += second[i];
+    }
+
+    uint8_t *out = dst + y * dst_pitch;
+    for (GLsizei x = 0; x < dst_width; ++x) {
+      const size_t x0 = static_cast<size_t>(2 * x) * channels;
+      const size_t x1 =
+          static_cast<size_t>(std::min(2 * x + 1, src_width - 1)) * channels;
+      int32_t values[4];
+#if defined(_M_X64) || defined(__x86_64__)
+      if (channels == 4) {
+        // rounds to the nearest, ties to even (as the scalar loop)
+        const __m128 v = _mm_mul_ps(
+            _mm_add_ps(_mm_loadu_ps(&sum[x0]), _mm_loadu_ps(&sum[x1])),
+            _mm_loadu_ps(scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(values),
+                         _mm_cvtps_epi32(v));
+      } else
+#endif
+      {
+        for (int k = 0; k < channels; ++k) {
+          // the default rounding mode, ties to even as _mm_cvtps_epi32
+          values[k] = static_cast<int32_t>(
+              std::nearbyint((sum[x0 + k] + sum[x1 + k]) * scale[k]));
+        }
+      }
+      for (int k = 0; k < channels; ++k) {
+        out[x * channels + k] = encode[k]
+                                    ? encode[k][values[k]]
+                                    : static_cast<uint8_t>(values[k]);
+      }
+    }
+  }
+}
+
+size_t GetLevelSize(GLsizei width, GLsizei height, int num_of_channels,
+                    bc::Format::Enum format) {
+  if (format == bc::Format::kNone) {
+    return GetPitch(width, num_of_channels) * height;
+  }
+  return bc::GetCompressedSize(format, width, height);
+}
+
+}  // namespace
+
+size_t GetPitch(GLsizei width, int num_of_channels) {
+  return (static_cast<size_t>(width) * num_of_channels + 3) & ~size_t{3};
+}
+
+const char *GetCacheExtension(TextureType::Enum type) {
+  switch (type) {
+    case TextureType::kDiffuse:
+    case TextureType::kEmissive:
+      return ".srgb.tex";
+    case TextureType::kNormals:
+      return ".normals.tex";
+    default:
+      return ".tex";
+  }
+}
+
+bc::Format::Enum GetBlockFormat(TextureType::Enum type, int num_of_channels,
+                                Compression::Enum compression) {
+  if (compression == Compression::kNone) return bc::Format::kNone;
+  switch (type) {
+    case TextureType::kDiffuse:
+    case TextureType::kEmissive:
+      if (num_of_channels < 3) return bc::Format::kNone;
+      if (compression == Compression::kHigh) return bc::Format::kBC7;
+      return num_of_channels == 4 ? bc::Format::kBC3 : bc::Format::kBC1;
+    case TextureType::kMetallic:
+    case TextureType::kRoughness:
+    case TextureType::kEmissiveFactor:
+      // the shaders read the red channel only
+      return bc::Format::kBC4;
+    case TextureType::kNormals:
+      return num_of_channels >= 2 ? bc::Format::kBC5 : bc::Format::kNone;
+    default:
+      return bc::Format::kNone;
+  }
+}
+
+void CookTexture(const Image &img, TextureType::Enum type,
+                 Compression::Enum compression, const Key &key, Blob &blob) {
+  const int channels = img.num_of_channels;
+  // GL_R8 and GL_RG8 are linear
+  const bool srgb = IsColorTexture(type) && channels >= 3;
+  const bc::Format::Enum format = GetBlockFormat(type, channels, compression);
+  const bc::Quality::Enum quality = compression == Compression::kHigh
+                                        ? bc::Quality::kHigh
+                                        : bc::Quality::kFast;
+  GLsizei width = img.width;
+  GLsizei height = img.height;
+  const GLsizei levels = GetLevelCount(width, height);
+  // 4/3 of the first level
+  const size_t first = GetLevelSize(width, height, channels, format);
+  blob.reserve(blob.size() + first * 4 / 3 + levels * 32 + 64);
+
+  Writer writer(blob);
+  WriteHeader(writer, kMagic, kTextureVersion, key);
+  writer.Pod(width);
+  writer.Pod(height);
+  writer.Pod(channels);
+  writer.Pod(format);
+  writer.Pod(static_cast<uint32_t>(levels));
+
+  // stb rows are packed
+  const size_t packed = static_cast<size_t>(width) * channels;
+  Blob current(GetPitch(width, channels) * height, 0);
+  for (GLsizei y = 0; y < height; ++y) {
+    std::memcpy(current.data() + y * GetPitch(width, channels),
+                img.data + y * packed, packed);
+  }
+
+  Blob next;
+  Blob blocks;
+  for (GLsizei level = 0; level < levels; ++level) {
+    writer.Pod(width);
+    writer.Pod(height);
+    if (format == bc::Format::kNone) {
+      writer.Array(std::span<const char>(current));
+    } else {
+      // the mips are filtered from the uncompressed level
+      blocks.resize(bc::GetCompressedSize(format, width, height));
+      bc::Encode(format, quality,
+                 reinterpret_cast<const uint8_t *>(current.data()), width,
+                 height, GetPitch(width, channels), channels,
+                 reinterpret_cast<uint8_t *>(blocks.data()));
+      writer.Array(std::span<const char>(blocks));
+    }
+    if (level + 1 == levels) break;
+
+    const GLsizei next_width = std::max(width / 2, 1);
+    const GLsizei next_height = std::max(height / 2, 1);
+    next.assign(GetPitch(next_width, channels) * next_height, 0);
+    Downsample(reinterpret_cast<const uint8_t *>(current.data()), width,
+               height, reinterpret_cast<uint8_t *>(next.data()), next_width,
+               next_height, channels, srgb);
+    std::swap(current, next);
+    width = next_width;
+    height = next_height;
+  }
+}
+
+bool ParseTexture(std::span<const char> blob, const Key &key,
+                  TextureData &texture) {
+  Reader reader(blob);
+  if (!ReadHeader(reader, kMagic, kTextureVersion, key)) return false;
+
+  texture.width = reader.Pod<GLsizei>();
+  texture.height = reader.Pod<GLsizei>();
+  texture.num_of_channels = reader.Pod<int>();
+  texture.format = reader.Pod<bc::Format::Enum>();
+  if (texture.num_of_channels < 1 || texture.num_of_channels > 4 ||
+      texture.format >= bc::Format::kTotal) {
+    reader.Fail();
+    texture.format = bc::Format::kNone;
+  }
+  texture.levels.resize(reader.Count());
+  for (auto &level : texture.levels) {
+    level.width = reader.Pod<GLsizei>();
+    level.height = reader.Pod<GLsizei>();
+    level.pixels = reader.Array<char>();
+    if (level.pixels.size() != GetLevelSize(level.width, level.height,
+                                            texture.num_of_channels,
+                                            texture.format)) {
+      reader.Fail();
+    }
+  }
+
+  if (!reader.IsOk() || !reader.IsEnd() || texture.levels.empty()) {
+    spdlog::error("{}: Corrupted texture cache", __FUNCTION__);
+    texture = TextureData{};
+    return false;
+  }
+  return true;
+}
+
+}  // namespace cooked
@@ -0,0 +1,66 @@
+#pragma once
+
+// global
+#include <cstdint>
+#include <span>
+// local
+#include "assets/block_compression.h"
+#include "assets/cooked_blob.h"
+#include "assets/texture.h"
+#include "global.h"
+#include "mi_types.h"
+
+// cooked textures, the full mip chain of 8 bit channels generated on the CPU
+// and block compressed (assets/block_compression.h) per TextureType
+// cold start: stb decode -> CookTexture() -> Save(), warm start: the mapped
+// file, both are parsed to views and uploaded level by level
+// resources/cache/<source path>[.srgb|.normals].tex (GetCacheExtension)
+namespace cooked {
+
+// bump on any change of the layout, of the filtering or of the encoder
+inline constexpr uint32_t kTextureVersion = 3;
+
+// app::cpu.texture_compression
+// kFast: BC1 (opaque) and BC3 (alpha) colors, kHigh: BC7 colors
+// both: BC5 normals (Z is reconstructed in the shader), BC4 single channel
+struct Compression {
+  enum Enum : uint32_t { kNone, kFast, kHigh, kTotal };
+};
+
+// kNone: rows 4 bytes aligned (the default GL_UNPACK_ALIGNMENT)
+// otherwise the blocks, the partial ones included
+struct TextureLevel {
+  GLsizei width;
+  GLsizei height;
+  std::span<const char> pixels;
+};
+
+// the levels are views into the blob, it must outlive them
+struct TextureData {
+  GLsizei width;
+  GLsizei height;
+  int num_of_channels;
+  bc::Format::Enum format;
+  MiVector<TextureLevel> levels;
+};
+
+// bytes per row of the level
+size_t GetPitch(GLsizei width, int num_of_channels);
+
+// for GetCachePath(), one file can be used as a color, normals or a mask
+// and every use is cooked differently
+const char *GetCacheExtension(TextureType::Enum type);
+// the block format of the texture, kNone if it stays uncompressed
+bc::Format::Enum GetBlockFormat(TextureType::Enum type, int num_of_channels,
+                                Compression::Enum compression);
+// 2x2 box filter down to 1x1, the same as glGenerateMipmap
+// colors (IsColorTexture): RGB are filtered in the linear space (decoded and
+// encoded), alpha and the linear textures as is, then every level is
+// compressed, import_flags of the key are srgb and compression
+void CookTexture(const Image &img, TextureType::Enum type,
+                 Compression::Enum compression, const Key &key, Blob &blob);
+// false if the blob is not of this version or of another key
+bool ParseTexture(std::span<const char> blob, const Key &key,
+                  TextureData &texture);
+
+}  // namespace cooked
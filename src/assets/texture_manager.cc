@@ -3,12 +3,69 @@
 // deps
 #include <spdlog/spdlog.h>
 #include <stb_image.h>
+// global
+#include <chrono>
 // local
 #include "app/main_thread.h"
+#include "app/parameters.h"
+#include "app/task_system.h"
+#include "assets/loading_report.h"
+#include "assets/texture_cache.h"
 #include "files.h"
 #include "options.h"
 #include "ui/win_resources.h"
 #include "utils/enums.h"
+#include "utils/metrics.h"
+
+namespace {
+
+metrics::Gauge gResident{"textures.resident"};
+metrics::Counter gCacheHits{"textures.cache_hits"};
+metrics::Counter gCacheMisses{"textures.cache_misses"};
+// the requests that waited for a load in progress instead of decoding
+metrics::Counter gSharedLoads{"textures.shared_loads"};
+
+// warm start: the mapped cache, cold start: decode, mips and the cooked blob
+// the levels of the texture point into one of them
+bool LoadCooked(const std::string &path, TextureType::Enum type,
+                files::MappedFile &cache, cooked::Blob &blob,
+                cooked::TextureData &texture) {
+  const bool srgb = IsColorTexture(type);
+  const auto compression =
+      static_cast<cooked::Compression::Enum>(app::cpu.texture_compression);
+  cooked::Key key;
+  fs::path cache_path;
+  if (app::cpu.texture_cache) {
+    loading::PhaseTimer read(loading::Phase::kFileRead);
+    files::MappedFile source;
+    // another compression is another cache
+    const uint32_t flags = srgb | compression << 1;
+    if (source.Open(path)) key = cooked::MakeKey(source.GetData(), flags);
+    cache_path = cooked::GetCachePath(path, cooked::GetCacheExtension(type));
+    read.AddBytes(source.GetData().size());
+    if (cache.Open(cache_path) &&
+        cooked::ParseTexture(cache.GetData(), key, texture)) {
+      read.AddBytes(cache.GetData().size());
+      gCacheHits.Add();
+      return true;
+    }
+    cache.Close();
+  }
+
+  Image img{path};
+  if (img.success == false) return false;
+  {
+    // the mip chain and the compression are a part of the decode
+    loading::PhaseTimer mips(loading::Phase::kTextureDecode);
+    cooked::CookTexture(img, type, compression, key, blob);
+    mips.AddBytes(blob.size());
+  }
+  gCacheMisses.Add();
+  if (app::cpu.texture_cache) cooked::Save(cache_path, blob);
+  return cooked::ParseTexture(blob, key, texture);
+}
+
+}  // namespace
 
 TextureManager::TextureManager(ui::WinResources &ui) : ui_(ui) {
   // stbi global variables (OpenGL)
@@ -75,36 +132,149 @@ void TextureManager::MakeTexHandler(SmartTexture &texture) {
   GLuint64 handler = glGetTextureSamplerHandleARB(tbo, sampler);
   texture.SetHandler(handler);
   glMakeTextureHandleResidentARB(handler);
+  gResident.Add(1);
 }
 
 // https://community.khronos.org/t/bindless-textures-resident-textures-limits/109122/2
 // resident textures have a limit, space for the handlers is allocated by OS
 // driver
+// once per texture, the loader and the resident callers can race for it
 void TextureManager::CreateTexHandlerMainThread(SmartTexture &texture) {
   // handlers must be resident on the main context
   if (app::main_thread::IsMainThread()) {
-    MakeTexHandler(texture);
+    MakeResidentMainThread(texture);
   } else {
     std::packaged_task<void()> package(
-        [this, &texture]() { MakeTexHandler(texture); });
+        [this, &texture]() { MakeResidentMainThread(texture); });
     auto future = app::main_thread::PushTask(package);
     future.get();
   }
 }
 
 std::shared_ptr<SmartTexture> TextureManager::CreateTextureMt(
-    const std::string &path, TextureType::Enum type) {
-  if (IsLoadedMt(path)) return GetTextureMt(path);
+    const std::string &path, TextureType::Enum type, bool resident) {
+  std::promise<std::shared_ptr<SmartTexture>> promise;
+  InFlight pending;
+  std::shared_ptr<SmartTexture> texture;
+  bool mapped = false;
+  {
+    std::scoped_lock lock(mutex_);
+    if (auto it = tex_map_.find(path); it != tex_map_.end()) {
+      texture = it->second.lock();
+      mapped = true;
+    } else {
+      auto [it, first] = in_flight_.try_emplace(path);
+      if (first) {
+        it->second = {promise.get_future().share(), resident};
+      } else {
+        pending.texture = it->second.texture;
+        pending.resident = it->second.resident;
+      }
+    }
+  }
 
-  Image img{path};
-  if (img.success == false) return GetTextureMt(error_path_);
+  // published before its handler (LoadTextureMt) or loaded not resident
+  // the handler is atomic, the main thread can set it meanwhile
+  if (mapped) {
+    if (texture && resident && !texture->GetHandler()) {
+      loading::PhaseTimer handle(loading::Phase::kMainThreadWait);
+      CreateTexHandlerMainThread(*texture);
+    }
+    return texture;
+  }
 
+  if (pending.texture.valid()) {
+    gSharedLoads.Add();
+    loading::PhaseTimer wait(loading::Phase::kSharedWait);
+    if (app::main_thread::IsMainThread()) {
+      // the loader can wait for the main thread (the handler)
+      app::main_thread::DrainTasksUntil([&pending]() {
+        return pending.texture.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+      });
+    }
+    texture = pending.texture.get();
+    wait.End();
+    if (resident && !pending.resident) {
+      // other waiters can do the same, the main thread makes it once
+      loading::PhaseTimer handle(loading::Phase::kMainThreadWait);
+      CreateTexHandlerMainThread(*texture);
+    }
+    return texture;
+  }
+
+  try {
+    texture = LoadTextureMt(path, type, resident);
+  } catch (...) {
+    // the waiters get the same error, the next caller loads it again
+    FinishInFlightMt(path);
+    promise.set_exception(std::current_exception());
+    app::main_thread::Wake();
+    throw;
+  }
+  // the texture is in tex_map_ already, unless it failed
+  FinishInFlightMt(path);
+  promise.set_value(texture);
+  app::main_thread::Wake();
+  return texture;
+}
+
+bool TextureManager::InFlightAwaiter::await_suspend(
+    std::coroutine_handle<> handle) {
+  std::scoped_lock lock(manager_.mutex_);
+  auto it = manager_.in_flight_.find(path_);
+  if (it == manager_.in_flight_.end()) return false;
+  it->second.waiters.push_back(handle);
+  return true;
+}
+
+TextureManager::InFlightAwaiter TextureManager::WaitInFlightMt(
+    const std::string &path) {
+  return InFlightAwaiter{*this, path};
+}
+
+void TextureManager::FinishInFlightMt(const std::string &path) {
+  MiVector<std::coroutine_handle<>> waiters;
+  {
+    std::scoped_lock lock(mutex_);
+    auto it = in_flight_.find(path);
+    waiters = std::move(it->second.waiters);
+    in_flight_.erase(it);
+  }
+  // they find the texture in tex_map_ (or load it again if it failed)
+  for (auto handle : waiters) {
+    app::task::PushGlTask([handle](int) { handle.resume(); });
+  }
+}
+
+std::shared_ptr<SmartTexture> TextureManager::LoadTextureMt(
+    const std::string &path, TextureType::Enum type, bool resident) {
+  // nested in the model that is loaded on this thread
+  loading::Asset asset = loading::Begin(path, "texture");
+  loading::Scope scope(asset);
+  files::MappedFile cache;
+  cooked::Blob blob;
+  cooked::TextureData data;
+  if (LoadCooked(path, type, cache, blob, data) == false) {
+    loading::End(asset);
+    return GetTextureMt(error_path_);
+  }
+
+  loading::PhaseTimer upload(loading::Phase::kGlUpload);
+  for (const auto &level : data.levels) {
+    upload.AddBytes(level.pixels.size());
+  }
   sync_.BeginMt();
-  auto texture = std::make_shared<SmartTexture>(img, type, *this);
+  auto texture = std::make_shared<SmartTexture>(data, type, *this);
   sync_.EndMt();
+  upload.End();
 
   AddTextureMt(path, type, texture);
-  CreateTexHandlerMainThread(*texture);
+  if (resident) {
+    loading::PhaseTimer handle(loading::Phase::kMainThreadWait);
+    CreateTexHandlerMainThread(*texture);
+  }
+  loading::End(asset);
   return texture;
 }
 
@@ -123,10 +293,11 @@ std::shared_ptr<SmartTexture> TextureManager::GetTextureMt(
 void TextureManager::RemoveTextureMt(id::Texture id, GLuint64 handler) {
   std::scoped_lock lock(mutex_);
 
-  // use main context
-  if (app::main_thread::IsMainThread()) {
+  // use main context, zero if never became resident
+  if (handler) gResident.Add(-1);
+  if (handler && app::main_thread::IsMainThread()) {
     glMakeTextureHandleNonResidentARB(handler);
-  } else {
+  } else if (handler) {
     std::packaged_task<void()> package(
         [handler]() { glMakeTextureHandleNonResidentARB(handler); });
     auto future = app::main_thread::PushTask(package);
@@ -143,12 +314,20 @@ bool TextureManager::IsLoadedMt(const std::string &path) const {
   return tex_map_.contains(path);
 }
 
+void TextureManager::MakeResidentMainThread(SmartTexture &texture) {
+  if (texture.GetHandler()) return;
+  MakeTexHandler(texture);
+}
+
 void TextureManager::ApplyTextureSettingsMainThread() {
   for (const auto &[name, weak_ptr] : tex_map_) {
     auto &texture = *weak_ptr.lock();
-    // remove old
+    // loading in progress, the loader makes it resident
     GLuint64 old_handler = texture.GetHandler();
+    if (old_handler == 0) continue;
+    // remove old
     glMakeTextureHandleNonResidentARB(old_handler);
+    gResident.Add(-1);
     // make new pair (same settings produce same handlers)
     MakeTexHandler(texture);
   }
@@ -2,6 +2,8 @@
 
 // global
 #include <array>
+#include <coroutine>
+#include <future>
 #include <memory>
 #include <mutex>
 // local
@@ -9,6 +11,7 @@
 #include "mi_types.h"
 #include "opengl/fence_sync.h"
 #include "opengl/sampler.h"
+#include "utils/profiling.h"
 // fwd
 namespace ui {
 class WinResources;
@@ -23,19 +26,42 @@ class TextureManager {
   // profiling (i7-6700k, RTX 3070 Ti)
   // image to RAM: ~90% (stbi, png - longest time, tga - compressed best)
   // OpenGL texture: ~10% avg
+  // resident == false: no main thread hop, see MakeResidentMainThread()
+  // single flight: the first caller loads the path, the concurrent callers
+  // wait for its texture (the error texture if it failed)
+  // the worker waiters block, the coroutines co_await WaitInFlightMt() first
   std::shared_ptr<SmartTexture> CreateTextureMt(const std::string &path,
-                                                TextureType::Enum type);
+                                                TextureType::Enum type,
+                                                bool resident = true);
+  // suspends while another caller loads the path, resumes on a GL worker
+  // (the loader pushes it), no-op if the path isn't in flight
+  class InFlightAwaiter {
+   public:
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+
+   private:
+    friend class TextureManager;
+    InFlightAwaiter(TextureManager &manager, const std::string &path)
+        : manager_(manager), path_(path) {}
+    TextureManager &manager_;
+    const std::string &path_;
+  };
+  InFlightAwaiter WaitInFlightMt(const std::string &path);
   std::shared_ptr<SmartTexture> GetTextureMt(const std::string &path) const;
   bool IsLoadedMt(const std::string &path) const;
   void RemoveTextureMt(id::Texture id, GLuint64 handler);
 
+  // no-op if the texture already has a handler
+  void MakeResidentMainThread(SmartTexture &texture);
   void ApplyTextureSettingsMainThread();
   MiUnMap<id::Texture, long> CalcTextureUseCount() noexcept;
 
  private:
   ui::WinResources &ui_;
 
-  mutable std::mutex mutex_;
+  mutable prof::Mutex mutex_{"TextureManager"};
   gl::Sync sync_;
   std::array<std::array<gl::Sampler2D, 5>, 5> samplers_;
   // the members order is important!
@@ -43,6 +69,15 @@ class TextureManager {
   MiUnMap<id::Texture, std::string> id_to_path_;
   MiUnMap<std::string, std::weak_ptr<SmartTexture>> tex_map_;
   MiVector<std::shared_ptr<SmartTexture>> internal_textures_;
+  // loads in progress, removed when the texture is in tex_map_
+  struct InFlight {
+    std::shared_future<std::shared_ptr<SmartTexture>> texture;
+    // made resident by the loader before the result is set
+    bool resident;
+    // suspended coroutines, resumed after the result is set
+    MiVector<std::coroutine_handle<>> waiters;
+  };
+  MiUnMap<std::string, InFlight> in_flight_;
 
   std::string error_path_;
   std::string blank_black0_path_;
@@ -52,9 +87,14 @@ class TextureManager {
   GLuint GetCurrentSampler() const;
   void AddTextureMt(const std::string &path, TextureType::Enum type,
                     const std::shared_ptr<SmartTexture> &texture);
+  // the loader's part, the waiters continue on the GL workers
+  void FinishInFlightMt(const std::string &path);
 
   void MakeTexHandler(SmartTexture &texture);
   void CreateTexHandlerMainThread(SmartTexture &texture);
+  std::shared_ptr<SmartTexture> LoadTextureMt(const std::string &path,
+                                              TextureType::Enum type,
+                                              bool resident);
 
   void CreateInternalTexture(const std::string &path, TextureType::Enum type);
 };
\ No newline at end of file
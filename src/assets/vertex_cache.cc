@@ -0,0 +1,276 @@
+#include "vertex_cache.h"
+
+// global
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+// local
+#include "utils/profiling.h"
+
+namespace vertex {
+
+namespace {
+
+constexpr unsigned int kNone = ~0U;
+// a soft cluster is closed when its ACMR is within 5% of the mesh's
+// smaller clusters sort better, each one costs some cache misses
+constexpr float kClusterThreshold = 1.05f;
+
+// the triangles of every vertex, offsets[v] to offsets[v + 1]
+struct Adjacency {
+  MiVector<unsigned int> offsets;
+  MiVector<unsigned int> triangles;
+};
+
+void BuildAdjacency(std::span<const unsigned int> indices, size_t vertex_count,
+                    Adjacency &adjacency) {
+  auto &offsets = adjacency.offsets;
+  offsets.assign(vertex_count + 1, 0);
+  for (unsigned int index : indices) {
+    ++offsets[index + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  MiVector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+  adjacency.triangles.resize(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    adjacency.triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+  }
+}
+
+// the vertex is in the FIFO if it was added in the last cache_size misses
+// time starts at cache_size + 1, cache_time at 0 (all missing)
+bool IsCached(unsigned int time, unsigned int cache_time,
+              unsigned int cache_size) {
+  return time - cache_time <= cache_size;
+}
+
+// the most recent vertex with triangles left, then the input order
+unsigned int SkipDeadEnd(const MiVector<unsigned int> &live,
+                         MiVector<unsigned int> &dead_end, size_t &cursor) {
+  while (!dead_end.empty()) {
+    const unsigned int vertex = dead_end.back();
+    dead_end.pop_back();
+    if (live[vertex] > 0) return vertex;
+  }
+  for (; cursor < live.size(); ++cursor) {
+    if (live[cursor] > 0) return static_cast<unsigned int>(cursor);
+  }
+  return kNone;
+}
+
+// fans around one vertex at a time, the next one is the oldest vertex
+// of the last fan that stays in the cache with its remaining triangles
+void Tipsify(std::span<const unsigned int> indices, size_t vertex_count,
+             unsigned int cache_size, MiVector<unsigned int> &order) {
+  Adjacency adjacency;
+  BuildAdjacency(indices, vertex_count, adjacency);
+
+  MiVector<unsigned int> live(vertex_count);
+  for (size_t v = 0; v < vertex_count; ++v) {
+    live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+  }
+  MiVector<unsigned int> cache_time(vertex_count, 0);
+  MiVector<uint8_t> emitted(indices.size() / 3, 0);
+  MiVector<unsigned int> dead_end;
+  dead_end.reserve(indices.size());
+  MiVector<unsigned int> candidates;
+  unsigned int time = cache_size + 1;
+  size_t cursor = 0;
+
+  order.clear();
+  order.reserve(indices.size() / 3);
+  unsigned int fanning = SkipDeadEnd(live, dead_end, cursor);
+  while (fanning != kNone) {
+    candidates.clear();
+    for (unsigned int i = adjacency.offsets[fanning];
+         i < adjacency.offsets[fanning + 1]; ++i) {
+      const unsigned int triangle = adjacency.triangles[i];
+      if (emitted[triangle]) continue;
+      emitted[triangle] = 1;
+      order.push_back(triangle);
+      for (unsigned int k = 0; k < 3; ++k) {
+        const unsigned int vertex = indices[triangle * 3 + k];
+        dead_end.push_back(vertex);
+        candidates.push_back(vertex);
+        --live[vertex];
+        if (!IsCached(time, cache_time[vertex], cache_size)) {
+          cache_time[vertex] = time++;
+        }
+      }
+    }
+
+    fanning = kNone;
+    int best = -1;
+    for (unsigned int vertex : candidates) {
+      if (live[vertex] == 0) continue;
+      // 0 if the fans of its triangles would push it out
+      int priority = 0;
+      const unsigned int age = time - cache_time[vertex];
+      if (age + 2 * live[vertex] <= cache_size) {
+        priority = static_cast<int>(age);
+      }
+      if (priority > best) {
+        best = priority;
+        fanning = vertex;
+      }
+    }
+    if (fanning == kNone) {
+      fanning = SkipDeadEnd(live, dead_end, cursor);
+    }
+  }
+}
+
+struct Cluster {
+  size_t first;
+  size_t count;
+  float key;
+};
+
+// Sander's linear-speed overdraw: the cache order is split at the cache
+// flushes (hard) and where the ACMR is good enough (soft), the clusters
+// facing away from the center are drawn first and occlude the inner ones
+void SortClusters(std::span<unsigned int> indices,
+                  std::span<const glm::vec3> positions,
+                  unsigned int cache_size) {
+  const size_t triangle_count = indices.size() / 3;
+  const float threshold =
+      kClusterThreshold *
+      GetCacheStats(indices, positions.size(), cache_size).acmr;
+
+  MiVector<Cluster> clusters;
+  MiVector<unsigned int> cache_time(positions.size(), 0);
+  unsigned int time = cache_size + 1;
+  size_t first = 0;
+  size_t misses = 0;
+  for (size_t t = 0; t < triangle_count; ++t) {
+    unsigned int triangle_misses = 0;
+    for (size_t k = 0; k < 3; ++k) {
+      const unsigned int vertex = indices[t * 3 + k];
+      if (!IsCached(time, cache_time[vertex], cache_size)) {
+        cache_time[vertex] = time++;
+        ++triangle_misses;
+      }
+    }
+    // hard boundary, the cache was flushed
+    if (triangle_misses == 3 && t > first) {
+      clusters.push_back({first, t - first, 0.0f});
+      first = t;
+      misses = 0;
+    }
+    misses += triangle_misses;
+    // soft boundary, the cache is flushed: a cluster drawn after any
+    // other one misses its first vertices anyway
+    if (misses <= threshold * (t + 1 - first)) {
+      clusters.push_back({first, t + 1 - first, 0.0f});
+      first = t + 1;
+      misses = 0;
+      time += cache_size + 1;
+    }
+  }
+  if (first < triangle_count) {
+    clusters.push_back({first, triangle_count - first, 0.0f});
+  }
+  if (clusters.size() < 2) return;
+
+  // area weighted centroids and normals
+  auto get_triangle = [&](size_t t, glm::vec3 &center) {
+    const glm::vec3 &p0 = positions[indices[t * 3 + 0]];
+    const glm::vec3 &p1 = positions[indices[t * 3 + 1]];
+    const glm::vec3 &p2 = positions[indices[t * 3 + 2]];
+    center = (p0 + p1 + p2) / 3.0f;
+    return glm::cross(p1 - p0, p2 - p0);
+  };
+  glm::vec3 mesh_center{0.0f};
+  float mesh_area = 0.0f;
+  for (size_t t = 0; t < triangle_count; ++t) {
+    glm::vec3 center;
+    const float area = glm::length(get_triangle(t, center));
+    mesh_center += center * area;
+    mesh_area += area;
+  }
+  if (mesh_area > 0.0f) mesh_center /= mesh_area;
+
+  for (auto &cluster : clusters) {
+    glm::vec3 center{0.0f};
+    glm::vec3 normal{0.0f};
+    float area = 0.0f;
+    for (size_t t = cluster.first; t < cluster.first + cluster.count; ++t) {
+      glm::vec3 triangle_center;
+      const glm::vec3 triangle_normal = get_triangle(t, triangle_center);
+      const float triangle_area = glm::length(triangle_normal);
+      center += triangle_center * triangle_area;
+      normal += triangle_normal;
+      area += triangle_area;
+    }
+    const float length = glm::length(normal);
+    if (area > 0.0f && length > 0.0f) {
+      cluster.key = glm::dot(center / area - mesh_center, normal / length);
+    }
+  }
+
+  // stable, the same input gives the same cooked blob
+  std::stable_sort(
+      clusters.begin(), clusters.end(),
+      [](const Cluster &a, const Cluster &b) { return a.key > b.key; });
+  MiVector<unsigned int> sorted;
+  sorted.reserve(indices.size());
+  for (const auto &cluster : clusters) {
+    sorted.insert(sorted.end(), indices.begin() + cluster.first * 3,
+                  indices.begin() + (cluster.first + cluster.count) * 3);
+  }
+  std::copy(sorted.begin(), sorted.end(), indices.begin());
+}
+
+}  // namespace
+
+CacheStats GetCacheStats(std::span<const unsigned int> indices,
+                         size_t vertex_count, unsigned int cache_size) {
+  CacheStats stats;
+  if (indices.size() < 3 || vertex_count == 0) return stats;
+
+  MiVector<unsigned int> cache_time(vertex_count, 0);
+  unsigned int time = cache_size + 1;
+  for (unsigned int vertex : indices) {
+    if (!IsCached(time, cache_time[vertex], cache_size)) {
+      cache_time[vertex] = time++;
+      ++stats.transforms;
+    }
+  }
+  stats.acmr = static_cast<float>(stats.transforms) / (indices.size() / 3);
+  stats.atvr = static_cast<float>(stats.transforms) / vertex_count;
+  return stats;
+}
+
+void OptimizeTriangles(std::span<unsigned int> indices,
+                       std::span<const glm::vec3> positions) {
+  if (indices.size() < 6 || indices.size() % 3 != 0) return;
+  prof::Zone zone("Vertex Cache");
+
+  MiVector<unsigned int> order;
+  Tipsify(indices, positions.size(), kCacheSize, order);
+  MiVector<unsigned int> reordered;
+  reordered.reserve(indices.size());
+  for (unsigned int triangle : order) {
+    reordered.insert(reordered.end(), indices.begin() + triangle * 3,
+                     indices.begin() + triangle * 3 + 3);
+  }
+  std::copy(reordered.begin(), reordered.end(), indices.begin());
+
+  SortClusters(indices, positions, kCacheSize);
+}
+
+void OptimizeVertexFetch(std::span<unsigned int> indices, size_t vertex_count,
+                         Stream<unsigned int> &remap) {
+  remap.assign(vertex_count, kNone);
+  unsigned int next = 0;
+  for (auto &index : indices) {
+    if (remap[index] == kNone) remap[index] = next++;
+    index = remap[index];
+  }
+  for (auto &vertex : remap) {
+    if (vertex == kNone) vertex = next++;
+  }
+}
+
+}  // namespace vertex
@@ -0,0 +1,55 @@
+#pragma once
+
+// global
+#include <span>
+// local
+#include "assets/vertex_data.h"
+#include "global.h"
+
+// import time order of the indexed triangles and of the vertices
+// 1. post-transform vertex cache: Tipsify (Sander, Nehab, Barczak 2007)
+// 2. overdraw: the clusters of the cache order, the outer ones first
+// 3. vertex fetch: the vertices in the order of their first use
+// CPU only, the cooked models store the result (assets/model_cache.h)
+namespace vertex {
+
+// FIFO of the simulated post-transform cache, the optimizer targets it
+inline constexpr unsigned int kCacheSize = 16;
+
+struct CacheStats {
+  // average cache miss ratio, transformed vertices per triangle
+  // 3 is the worst, ~0.5 the best of a regular grid
+  float acmr{0.0f};
+  // average transform to vertex ratio, 1 is the best
+  float atvr{0.0f};
+  size_t transforms{0};
+};
+
+// triangle lists only
+CacheStats GetCacheStats(std::span<const unsigned int> indices,
+                         size_t vertex_count,
+                         unsigned int cache_size = kCacheSize);
+
+// reorders the triangles in place for the vertex cache and then the
+// clusters of it for the overdraw (positions, the vertex count)
+void OptimizeTriangles(std::span<unsigned int> indices,
+                       std::span<const glm::vec3> positions);
+
+// remap[old] = new: the first used vertex is 0, the unused go last
+// the indices are rewritten
+void OptimizeVertexFetch(std::span<unsigned int> indices, size_t vertex_count,
+                         Stream<unsigned int> &remap);
+
+// dst[remap[v]] = src[v], components values per vertex
+template <typename T>
+void RemapStream(std::span<const T> src, std::span<const unsigned int> remap,
+                 size_t components, Stream<T> &dst) {
+  dst.resize(remap.size() * components);
+  for (size_t v = 0; v < remap.size(); ++v) {
+    for (size_t c = 0; c < components; ++c) {
+      dst[remap[v] * components + c] = src[v * components + c];
+    }
+  }
+}
+
+}  // namespace vertex
@@ -0,0 +1,88 @@
+#include "vertex_data.h"
+
+// deps
+#include <assimp/scene.h>
+// global
+#include <string>
+// local
+#include "assets/animation.h"
+#include "math/assimp_to_glm.h"
+
+namespace vertex {
+
+void ExtractTexCoords(const aiMesh *mesh, Stream<float> &tex_coords) {
+  tex_coords.reserve(tex_coords.size() + mesh->mNumVertices * 2);
+  for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+    tex_coords.push_back(mesh->mTextureCoords[0][i].x);
+    tex_coords.push_back(mesh->mTextureCoords[0][i].y);
+  }
+}
+
+void ExtractIndices(const aiMesh *mesh, Stream<unsigned int> &indices) {
+  for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+    const aiFace &face = mesh->mFaces[i];
+    for (unsigned int j = 0; j < face.mNumIndices; ++j) {
+      indices.push_back(face.mIndices[j]);
+    }
+  }
+}
+
+// quite fast, under 1ms avg
+void ExtractBoneWeight(const aiMesh *mesh, Skeleton &skeleton,
+                       Stream<glm::ivec4> &bones, Stream<glm::vec4> &weights) {
+  auto &bone_map = skeleton.bone_map;
+  auto &bone_to_local = skeleton.bone_to_local;
+  auto &bone_box = skeleton.bone_box;
+
+  auto &bones_per_mesh = skeleton.bones_per_model.emplace_back();
+  bones_per_mesh.reserve(mesh->mNumBones);
+
+  for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+    int bone_id = 0;
+    const aiBone *bone = mesh->mBones[b];
+    std::string bone_name{bone->mName.C_Str()};
+
+    if (bone_map.contains(bone_name)) {
+      bone_id = bone_map.at(bone_name);
+    } else {
+      bone_id = static_cast<int>(bone_map.size());
+      bone_map.try_emplace(bone_name, bone_id);
+      bone_to_local.emplace_back(assglm::GetMatrix(bone->mOffsetMatrix));
+    }
+
+    const aiVertexWeight *vertex_weights = bone->mWeights;
+    unsigned int num_weights = bone->mNumWeights;
+
+    // Assimp/fbx doesn't have precomputed volumes around bones
+    AABB bb;
+    for (unsigned int w = 0; w < num_weights; ++w) {
+      unsigned int vertex_id = vertex_weights[w].mVertexId;
+      float weight = vertex_weights[w].mWeight;
+
+      // build box around bone vertices
+      bb.ExpandToInclude(assglm::GetVec(mesh->mVertices[vertex_id]));
+
+      // check a free slot
+      for (int i = 0; i < global::kMaxBonesPerVertex; ++i) {
+        if (weights[vertex_id][i] == 0.0f) {
+          bones[vertex_id][i] = bone_id;
+          weights[vertex_id][i] = weight;
+          break;
+        }
+      }
+    }
+
+    // one bone can overlap two different meshes
+    auto it = bone_box.find(bone_id);
+    if (it != bone_box.end()) {
+      it->second.ExpandToInclude(bb);
+    } else {
+      bone_box.try_emplace(bone_id, bb);
+    }
+
+    // record list of bone per mesh
+    bones_per_mesh.push_back(bone_id);
+  }
+}
+
+}  // namespace vertex
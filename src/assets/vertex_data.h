@@ -0,0 +1,26 @@
+#pragma once
+
+// local
+#include "global.h"
+#include "mem_info.h"
+// fwd
+struct Skeleton;
+struct aiMesh;
+
+// CPU part of the mesh loading, Assimp to vertex streams
+// no OpenGL, used by Mesh and the benchmarks
+namespace vertex {
+
+// temporary streams of the loaders, counted to the assets
+template <typename T>
+using Stream = mem::TagVector<T, mem::Tag::kAssets>;
+
+// mTextureCoords as vec3, sadly
+void ExtractTexCoords(const aiMesh *mesh, Stream<float> &tex_coords);
+void ExtractIndices(const aiMesh *mesh, Stream<unsigned int> &indices);
+// bones and weights are sized to the vertex count and zeroed
+// fills skeleton's bone map, offsets, boxes and bones per mesh
+void ExtractBoneWeight(const aiMesh *mesh, Skeleton &skeleton,
+                       Stream<glm::ivec4> &bones, Stream<glm::vec4> &weights);
+
+}  // namespace vertex
@@ -0,0 +1,140 @@
+#include "vertex_format.h"
+
+// deps
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/packing.hpp>
+// global
+#include <algorithm>
+#include <cmath>
+
+namespace vertex {
+
+namespace {
+
+// the smallest positive snorm16, y of the tangent can't be 0 with a sign
+constexpr float kMinSnorm = 1.0f / 32767.0f;
+
+float SignNotZero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+// the upper hemisphere is the inner diamond, the lower one is folded out
+glm::vec2 OctEncode(const glm::vec3 &v) {
+  const float sum = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+  if (sum == 0.0f) return glm::vec2(0.0f);
+  const glm::vec3 n = v / sum;
+  if (n.z >= 0.0f) return glm::vec2(n.x, n.y);
+  return glm::vec2((1.0f - std::abs(n.y)) * SignNotZero(n.x),
+                   (1.0f - std::abs(n.x)) * SignNotZero(n.y));
+}
+
+glm::vec3 OctDecode(const glm::vec2 &e) {
+  glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+  const float t = std::max(-n.z, 0.0f);
+  n.x += n.x >= 0.0f ? -t : t;
+  n.y += n.y >= 0.0f ? -t : t;
+  return glm::normalize(n);
+}
+
+}  // namespace
+
+uint32_t PackNormal(const glm::vec3 &normal) {
+  return glm::packSnorm2x16(OctEncode(normal));
+}
+
+uint32_t PackTangent(const glm::vec3 &normal, const glm::vec3 &tangent,
+                     const glm::vec3 &bitangent) {
+  glm::vec2 e = OctEncode(tangent);
+  // [-1, 1] to [kMinSnorm, 1], the sign is free
+  e.y = std::max(e.y * 0.5f + 0.5f, kMinSnorm);
+  if (glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f) e.y = -e.y;
+  return glm::packSnorm2x16(e);
+}
+
+uint32_t PackTexCoords(float u, float v) {
+  return glm::packHalf2x16(glm::vec2(u, v));
+}
+
+glm::vec3 UnpackNormal(uint32_t packed) {
+  return OctDecode(glm::unpackSnorm2x16(packed));
+}
+
+void UnpackTangent(uint32_t packed, const glm::vec3 &normal,
+                   glm::vec3 &tangent, glm::vec3 &bitangent) {
+  glm::vec2 e = glm::unpackSnorm2x16(packed);
+  const float sign = SignNotZero(e.y);
+  e.y = std::abs(e.y) * 2.0f - 1.0f;
+  tangent = OctDecode(e);
+  bitangent = glm::cross(normal, tangent) * sign;
+}
+
+glm::vec2 UnpackTexCoords(uint32_t packed) {
+  return glm::unpackHalf2x16(packed);
+}
+
+glm::i16vec4 PackBones(const glm::ivec4 &bones) {
+  return glm::i16vec4(glm::clamp(bones, 0, kMaxPackedBones));
+}
+
+glm::u8vec4 PackWeights(const glm::vec4 &weights) {
+  const glm::vec4 positive = glm::max(weights, glm::vec4(0.0f));
+  const float sum = positive.x + positive.y + positive.z + positive.w;
+  glm::u8vec4 packed(0);
+  if (sum <= 0.0f) return packed;
+
+  // the floors lose less than 1 per slot, the largest fractions get it
+  const glm::vec4 scaled = positive / sum * static_cast<float>(kWeightsSum);
+  glm::vec4 fractions = scaled - glm::floor(scaled);
+  unsigned int total = 0;
+  for (int i = 0; i < 4; ++i) {
+    packed[i] = static_cast<uint8_t>(
+        std::min(scaled[i], static_cast<float>(kWeightsSum)));
+    total += packed[i];
+  }
+  for (; total < kWeightsSum; ++total) {
+    int best = 0;
+    for (int i = 1; i < 4; ++i) {
+      if (fractions[i] > fractions[best]) best = i;
+    }
+    ++packed[best];
+    fractions[best] = -1.0f;
+  }
+  // the float rounding, the largest slot gives back
+  for (; total > kWeightsSum; --total) {
+    int best = 0;
+    for (int i = 1; i < 4; ++i) {
+      if (packed[i] > packed[best]) best = i;
+    }
+    --packed[best];
+  }
+  return packed;
+}
+
+glm::vec4 UnpackWeights(const glm::u8vec4 &packed) {
+  return glm::vec4(packed) / static_cast<float>(kWeightsSum);
+}
+
+void ValidateSkin(std::span<const glm::ivec4> bones,
+                  std::span<const glm::vec4> weights,
+                  std::span<const glm::i16vec4> packed_bones,
+                  std::span<const glm::u8vec4> packed_weights,
+                  SkinErrors &errors) {
+  for (size_t v = 0; v < weights.size(); ++v) {
+    const glm::vec4 positive = glm::max(weights[v], glm::vec4(0.0f));
+    const float sum = positive.x + positive.y + positive.z + positive.w;
+    const glm::u8vec4 &packed = packed_weights[v];
+    const unsigned int packed_sum = packed.x + packed.y + packed.z + packed.w;
+    if (packed_sum != (sum > 0.0f ? kWeightsSum : 0)) ++errors.sums;
+    if (sum <= 0.0f) continue;
+
+    const glm::vec4 unpacked = UnpackWeights(packed);
+    bool bone_error = false;
+    for (int i = 0; i < 4; ++i) {
+      errors.max_weight = std::max(errors.max_weight,
+                                   std::abs(unpacked[i] - positive[i] / sum));
+      if (packed[i] && packed_bones[v][i] != bones[v][i]) bone_error = true;
+    }
+    if (bone_error) ++errors.bones;
+  }
+}
+
+}  // namespace vertex
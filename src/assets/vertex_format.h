@@ -0,0 +1,63 @@
+#pragma once
+
+// deps
+#include <glm/gtc/type_precision.hpp>
+// global
+#include <cstdint>
+#include <span>
+// local
+#include "global.h"
+
+// compact vertices of app::cpu.compact_vertices, see VertexFormat
+// static, 24 bytes instead of 56:
+// position: 3 floats, as is
+// normal: octahedral, 2 x snorm16
+// tangent: octahedral, 2 x snorm16, the sign of y is the sign of the
+// bitangent (cross(normal, tangent) * sign), y loses one bit
+// tex coords: 2 x half float
+// skinned, 12 bytes of the skin instead of 32 (the frame is full):
+// bones: 4 x int16, the shaders read ivec4 as before
+// weights: 4 x unorm8, renormalized, the sum is exactly kWeightsSum
+// packed at import (assets/model_cache.h), decoded by the vertex shaders
+// (shaders/vertex.glsl), no GL here, the benchmarks link it
+namespace vertex {
+
+// bone ids of a model, larger ones don't fit int16
+inline constexpr int kMaxPackedBones = 32767;
+// unorm8 of 1.0
+inline constexpr unsigned int kWeightsSum = 255;
+
+uint32_t PackNormal(const glm::vec3 &normal);
+uint32_t PackTangent(const glm::vec3 &normal, const glm::vec3 &tangent,
+                     const glm::vec3 &bitangent);
+uint32_t PackTexCoords(float u, float v);
+
+// reference decoders, the same math as the shaders
+glm::vec3 UnpackNormal(uint32_t packed);
+// the bitangent is reconstructed from the decoded normal
+void UnpackTangent(uint32_t packed, const glm::vec3 &normal,
+                   glm::vec3 &tangent, glm::vec3 &bitangent);
+glm::vec2 UnpackTexCoords(uint32_t packed);
+
+glm::i16vec4 PackBones(const glm::ivec4 &bones);
+// the largest remainders are rounded up, all zeros stay zeros
+glm::u8vec4 PackWeights(const glm::vec4 &weights);
+glm::vec4 UnpackWeights(const glm::u8vec4 &packed);
+
+// the packed skin against the float path of ExtractBoneWeight
+struct SkinErrors {
+  // the largest difference to the renormalized float weights
+  float max_weight{0.0f};
+  // vertices with another bone of a used slot
+  size_t bones{0};
+  // vertices with another sum than kWeightsSum (0 for no weights)
+  size_t sums{0};
+};
+
+void ValidateSkin(std::span<const glm::ivec4> bones,
+                  std::span<const glm::vec4> weights,
+                  std::span<const glm::i16vec4> packed_bones,
+                  std::span<const glm::u8vec4> packed_weights,
+                  SkinErrors &errors);
+
+}  // namespace vertex
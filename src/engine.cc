@@ -6,7 +6,19 @@
 #include "app/main_thread.h"
 #include "app/parameters.h"
 #include "app/task_system.h"
+#include "assets/loading_report.h"
 #include "files.h"
+#include "utils/alloc_tracking.h"
+#include "utils/metrics.h"
+#include "utils/profiling.h"
+
+namespace {
+
+metrics::Gauge gFrameUs{"frame.cpu_us"};
+// cumulative, since ResetWorkerStats()
+metrics::Counter gTasks{"task.executed"};
+
+}  // namespace
 
 Engine::Engine(Assets &assets, Scene &scene, Renderer &renderer, ui::Layout &ui)
     : event::Base<Engine>(&Engine::InitEvents, this),
@@ -46,40 +58,50 @@ void Engine::InitEvents() {
           []() { app::ApplyOpenGlMessageSeverity(); });
 }
 
-void Engine::LoadAssets() {
-  auto paths = files::meshes.GetFilePaths();
-
-  for (const auto &path : paths) {
-    app::task::PushTask([this, &path](unsigned int thread_id) {
-      assets_.models_.LoadModelMt(path, thread_id);
-    });
+app::coro::Task<void> Engine::LoadAssets() {
+  MiVector<app::coro::Task<void>> models;
+  for (const auto &path : files::meshes.GetFilePaths()) {
+    models.push_back(assets_.models_.LoadModelMt(path));
   }
-  app::task::WaitForTasks();
+  co_await app::coro::WhenAll(models);
 
   // batch upload misc parameters (optimization)
-  app::task::PushTask([this](unsigned int thread_id) {
-    assets_.models_.UploadCmdBoxMaterial();
-  });
-  app::task::WaitForTasks();
+  // starts when the last model is loaded, no global barrier
+  co_await app::coro::SwitchToGlWorker();
+  assets_.models_.UploadCmdBoxMaterial();
 }
 
-void Engine::LoadEnvMaps() {
-  auto paths = files::env_maps.GetFilePaths();
-
-  std::packaged_task<void()> package([this, &paths]() {
-    for (const auto &path : paths) {
-      Image img{path.string()};
-      if (img.success == false) continue;
-
-      Texture source{img, TextureType::kDiffuse};
-      // empty env texture (allocate memory)
-      auto env_tex = assets_.env_tex_.CreateEnvTexture(path.stem().string());
-      renderer_.RenderEnvironmentTexture(source.tbo_, env_tex);
+app::coro::Task<void> Engine::LoadEnvMaps() {
+  for (const auto &path : files::env_maps.GetFilePaths()) {
+    // decode on a worker, render on the main context
+    co_await app::coro::SwitchToWorker{app::task::Priority::kBackground};
+    loading::Asset asset = loading::Begin(path.stem().string(), "env map");
+    prof::Counter decode;
+    Image img{path.string()};
+    if (img.success == false) {
+      loading::End(asset);
+      continue;
     }
-  });
-
-  auto future = app::main_thread::PushTask(package);
-  future.get();
+    loading::Add(asset, loading::Phase::kTextureDecode,
+                 decode.GetElapsed<prof::fms>(),
+                 static_cast<uint64_t>(img.width) * img.height *
+                     img.num_of_channels);
+
+    prof::Counter wait;
+    co_await app::coro::SwitchToMainThread();
+    loading::Add(asset, loading::Phase::kMainThreadWait,
+                 wait.GetElapsed<prof::fms>());
+    // till the end of the iteration, before the next co_await
+    prof::Zone zone("Render Env Map");
+    prof::Counter upload;
+    Texture source{img, TextureType::kDiffuse};
+    // empty env texture (allocate memory)
+    auto env_tex = assets_.env_tex_.CreateEnvTexture(path.stem().string());
+    renderer_.RenderEnvironmentTexture(source.tbo_, env_tex);
+    loading::Add(asset, loading::Phase::kGlUpload,
+                 upload.GetElapsed<prof::fms>());
+    loading::End(asset);
+  }
 }
 
 void Engine::LoadIBLArchives() {
@@ -160,14 +182,32 @@ void Engine::SetState(State::Enum state) {
 }
 
 void Engine::Setup(const std::function<void(Engine &)> &setup) {
-  std::thread load_task(setup, std::ref(*this));
+  std::thread load_task(
+      [setup](Engine &engine) {
+        prof::SetThreadName("Loading");
+        setup(engine);
+      },
+      std::ref(*this));
   load_task.detach();
 }
 
 void Engine::Render() {
+  auto& cpu = renderer_.profiling_.cpu;
+  const float frame_ms = frame_.GetElapsed<prof::fms>();
+  cpu[CpuMetrics::kFrame].Add(frame_ms);
+  frame_.Start();
+  prof::MarkAllocFrame();
+  gFrameUs.Set(static_cast<int64_t>(frame_ms * 1000.0f));
+  gTasks.Set(static_cast<int64_t>(app::task::GetTasksExecuted()));
+  metrics::Sample();
+
   // all events once per frame
-  event::ProcessInput();
-  event::ProcessCustomEvents();
+  {
+    prof::Zone zone("Events");
+    event::ProcessInput();
+    event::ProcessCustomEvents();
+  }
+  cpu[CpuMetrics::kInput].Add(frame_.GetElapsed<prof::fms>());
   (this->*render_state_)();
 }
 
@@ -179,7 +219,13 @@ void Engine::DrawLoading() {
 void Engine::DrawScene() {
   // input's callbacks already done before Render()
   // UI events done here
-  ui_.StateEngine();
+  prof::Counter ui;
+  {
+    prof::Zone zone("UI");
+    ui_.StateEngine();
+  }
+  ui.End();
+  renderer_.profiling_.cpu[CpuMetrics::kUi].Add(ui.GetTime<prof::fms>());
 
   static bool call_once = [this]() {
     // after loading screen
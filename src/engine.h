@@ -1,6 +1,7 @@
 #pragma once
 
 // local
+#include "app/coro.h"
 #include "assets/assets.h"
 #include "events.h"
 #include "global.h"
@@ -17,8 +18,9 @@ class Engine : public event::Base<Engine> {
   Assets& assets_;
   Scene& scene_;
 
-  void LoadAssets();
-  void LoadEnvMaps();
+  // spawn into app::task::Group and wait, the main thread keeps rendering
+  app::coro::Task<void> LoadAssets();
+  app::coro::Task<void> LoadEnvMaps();
   void LoadIBLArchives();
   // multi-threaded state selection
   void SetState(State::Enum state);
@@ -29,6 +31,8 @@ class Engine : public event::Base<Engine> {
  private:
   Renderer& renderer_;
   ui::Layout& ui_;
+  // frame to frame, CpuMetrics::kFrame
+  prof::Counter frame_;
 
   using MemFn = void (Engine::*)();
   std::atomic<MemFn> render_state_ = &Engine::DrawLoading;
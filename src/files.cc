@@ -1,9 +1,20 @@
 #include "files.h"
 
+// os
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 // deps
 #include <spdlog/spdlog.h>
 // global
 #include <fstream>
+#include <utility>
 
 namespace files {
 
@@ -58,6 +69,70 @@ size_t FilesCount(const fs::path& path) {
       [](const auto& entry) { return entry.is_regular_file(); });
 }
 
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile&& o) noexcept
+    : data_(std::exchange(o.data_, nullptr)), size_(std::exchange(o.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+  if (this != &o) {
+    Close();
+    data_ = std::exchange(o.data_, nullptr);
+    size_ = std::exchange(o.size_, 0);
+  }
+  return *this;
+}
+
+bool MappedFile::Open(const fs::path& path) {
+  Close();
+#if defined(_WIN32)
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  // the view keeps the mapping alive
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping) return false;
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!view) return false;
+  size_ = static_cast<size_t>(size.QuadPart);
+#else
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) return false;
+  struct stat info {};
+  if (fstat(file, &info) != 0 || info.st_size == 0) {
+    close(file);
+    return false;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                    MAP_PRIVATE, file, 0);
+  close(file);
+  if (view == MAP_FAILED) return false;
+  size_ = static_cast<size_t>(info.st_size);
+#endif
+  data_ = static_cast<const char*>(view);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (!data_) return;
+#if defined(_WIN32)
+  UnmapViewOfFile(data_);
+#else
+  munmap(const_cast<char*>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
 PathInfo::PathInfo(const fs::path& p) : path(p), str(p.string()) {
   if (fs::exists(path)) {
     dirs_count = DirsCount(path);
@@ -2,6 +2,7 @@
 
 // global
 #include <filesystem>
+#include <span>
 #include <string>
 // local
 #include "mi_types.h"
@@ -18,6 +19,30 @@ size_t GetWriteTimeMS(const fs::path &path);
 size_t DirsCount(const fs::path &path);
 size_t FilesCount(const fs::path &path);
 
+// read-only mapping of the whole file, move-only
+// the pages are loaded on the first access, no copy
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&o) noexcept;
+  MappedFile &operator=(MappedFile &&o) noexcept;
+
+ public:
+  // false if missing or empty, the previous mapping is released
+  bool Open(const fs::path &path);
+  void Close();
+  bool IsOpen() const { return data_ != nullptr; }
+  // page aligned
+  std::span<const char> GetData() const { return {data_, size_}; }
+
+ private:
+  const char *data_{nullptr};
+  size_t size_{0};
+};
+
 struct PathInfo {
   PathInfo(const fs::path &p);
   fs::path path;
@@ -56,7 +56,9 @@ inline constexpr GLuint kMaxInstances = 256 * 1024;
 inline constexpr GLuint kMaxDrawCommands = 16 * 1024;
 inline constexpr const char* kEmptyName{"none"};
 // 4kk * sizeof(Static) == 4kk * 56 = 224mb
+// compact static (24 bytes) takes the same memory: 9.3kk vertices
 // 16kk * sizeof(Skinned) == 4kk * 88 = 352mb
+// compact skinned (68 bytes) takes the same memory: 5.1kk vertices
 inline constexpr GLuint kMaxVerticesPerMemBlock = 4 * 1024 * 1024;
 // 4kk * sizeof(GL_UNSIGNED_INT) == 16mb
 inline constexpr GLuint kMaxIndicesPerMemBlock = 4 * 1024 * 1024;
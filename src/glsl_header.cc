@@ -78,6 +78,8 @@ void StreamContent(fmt::v10::ostream &out) {
             global::kMaxPointLightsPerCluster);
 
   out.print(format, "DEBUG_READBACK_SIZE", global::kDebugReadbackSize);
+  // the frame of the static meshes, see shaders/vertex.glsl
+  out.print(format, "COMPACT_VERTICES", app::cpu.compact_vertices ? 1 : 0);
 
   out.print(str, "// Props flags\n");
   out.print(format, "ENABLED", fmt::underlying(Props::Flags::kEnabled));
@@ -5,15 +5,19 @@
 #endif
 // deps
 #include <fruit/fruit.h>
-#include <mimalloc-new-delete.h>
 #include <spdlog/spdlog.h>
 // local
 #include "app/application.h"
+#include "app/coro.h"
 #include "app/ini.h"
+#include "assets/loading_report.h"
 #include "engine.h"
 #include "events.h"
 #include "math/random.h"
+#include "mem_info.h"
 #include "options.h"
+#include "utils/metrics.h"
+#include "utils/profiling.h"
 
 void PlaceScene(Scene& scene) {
   auto& objects = scene.objects_;
@@ -129,6 +133,7 @@ int main(int argc, char* argv[]) {
   // load Application parameters and Engine options
   ini::Load(opt::set::GetIniDescription(), "engine.ini");
   event::SetKeybinds();
+  metrics::SetSampleInterval(app::cpu.metrics_interval);
 
   if (app::init::Application() == false) return 1;
 
@@ -140,8 +145,25 @@ int main(int argc, char* argv[]) {
     engine.SetState(State::Enum::kLoading);
 
     auto& scene = engine.scene_;
-    engine.LoadEnvMaps();
-    engine.LoadAssets();
+    // models are loaded by the workers while
+    // the main thread renders the environment maps
+    // (background priority, the frame jobs go first)
+    if (app::cpu.trace_loading) prof::StartCapture();
+    if (app::cpu.report_loading) loading::StartReport();
+    {
+      prof::Zone zone("Loading");
+      app::task::Group loading;
+      app::coro::Spawn(loading, engine.LoadEnvMaps(),
+                       app::task::Priority::kBackground);
+      app::coro::Spawn(loading, engine.LoadAssets(),
+                       app::task::Priority::kBackground);
+      loading.Wait();
+    }
+    if (app::cpu.trace_loading) prof::SaveCapture("trace_loading.json");
+    if (app::cpu.report_loading) loading::SaveReport("loading_report.json");
+    // owners of the loading peak and the locks that serialized it
+    mem::LogTagStats();
+    prof::LogLockStats();
 
     scene.SetEnvTexture("Newport_Loft_8k");
     PlaceScene(scene);
@@ -151,6 +173,10 @@ int main(int argc, char* argv[]) {
 
   // pass render function that use OpenGL and ImGui
   app::Run([&engine]() { engine.Render(); });
+  if (app::cpu.save_metrics) {
+    metrics::SaveCsv("metrics_series.csv");
+    metrics::SaveJson("metrics_series.json");
+  }
 
   return 0;
 }
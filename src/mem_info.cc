@@ -1,39 +1,93 @@
 #include "mem_info.h"
 
+// deps
+#include <mimalloc.h>
+#include <spdlog/spdlog.h>
 // global
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <mutex>
 // local
 #include "mi_types.h"
+#include "utils/enums.h"
+#include "utils/profiling.h"
 
 namespace mem {
 
 namespace {
-std::array<MiUnMap<const void*, GLuint64>, kTotal> gMaps;
-std::mutex gMutex;
+
+// GPU objects are registered by the loaders and the GL workers,
+// one lock per shard (by address) instead of one for everything
+constexpr size_t kShards = 16;
+
+struct alignas(64) Shard {
+  prof::Mutex mutex{"mem::Shard"};
+  MiUnMap<const void*, GLuint64> map;
+};
+
+std::array<std::array<Shard, kShards>, kTotal> gShards;
+std::array<std::atomic<GLuint64>, kTotal> gUsed{};
+
+Shard& GetShard(Type type, const void* obj) {
+  // objects are bigger than 64 bytes, skip the low bits
+  auto key = reinterpret_cast<uintptr_t>(obj) >> 6;
+  return gShards[type][key % kShards];
+}
+
+// relaxed: counters only, nothing is published through them
+struct alignas(64) TagCounter {
+  std::atomic<int64_t> current{0};
+  std::atomic<int64_t> peak{0};
+  std::atomic<uint64_t> allocations{0};
+};
+
+std::array<TagCounter, Tag::kTotal> gTags;
+
+void Count(Tag::Enum tag, int64_t bytes) {
+  auto& counter = gTags[tag];
+  int64_t current =
+      counter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  if (bytes <= 0) return;
+
+  counter.allocations.fetch_add(1, std::memory_order_relaxed);
+  int64_t peak = counter.peak.load(std::memory_order_relaxed);
+  while (current > peak && !counter.peak.compare_exchange_weak(
+                               peak, current, std::memory_order_relaxed)) {
+  }
+}
+
 }  // namespace
 
 void Add(Type type, const void* obj, GLuint64 bytes) {
-  std::scoped_lock lock(gMutex);
-  gMaps[type].try_emplace(obj, bytes);
+  auto& shard = GetShard(type, obj);
+  std::scoped_lock lock(shard.mutex);
+  if (shard.map.try_emplace(obj, bytes).second) {
+    gUsed[type].fetch_add(bytes, std::memory_order_relaxed);
+  }
 }
 
 void Erase(Type type, const void* obj) {
-  std::scoped_lock lock(gMutex);
-  auto& map = gMaps[type];
-  if (map.contains(obj)) {
-    map.erase(obj);
+  auto& shard = GetShard(type, obj);
+  std::scoped_lock lock(shard.mutex);
+  auto it = shard.map.find(obj);
+  if (it != shard.map.end()) {
+    gUsed[type].fetch_sub(it->second, std::memory_order_relaxed);
+    shard.map.erase(it);
   }
 }
 
 void Move(Type type, const void* other_obj, const void* this_obj) {
-  std::scoped_lock lock(gMutex);
-  auto& map = gMaps[type];
-  auto it = map.find(other_obj);
-  if (it != map.end()) {
-    size_t bytes = it->second;
-    map.try_emplace(this_obj, bytes);
+  GLuint64 bytes = 0;
+  {
+    auto& shard = GetShard(type, other_obj);
+    std::scoped_lock lock(shard.mutex);
+    auto it = shard.map.find(other_obj);
+    if (it == shard.map.end()) return;
+    bytes = it->second;
   }
+  // the moved-from object erases itself
+  Add(type, this_obj, bytes);
 }
 
 enum TexSpace : int { k1D, k2D, k3D };
@@ -188,24 +242,88 @@ GLuint64 SizeOfFormat(int internal_format) {
   }
 }
 
+// block compressed (4x4 texels), 0 for the rest
+GLuint64 BitsOfCompressedFormat(int internal_format) {
+  switch (internal_format) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1:
+      return 4;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RG_RGTC2:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
 GLuint64 CalcTexBytes2D(GLenum format, GLsizei level, GLuint64 size) {
   size = (level > 1) ? MipMap(k2D, size) : size;
+  if (GLuint64 bits = BitsOfCompressedFormat(format)) return bits * size / 8;
   size = SizeOfFormat(format) * size;
   return size;
 }
 
 GLuint64 CalcTexBytes3D(GLenum format, GLsizei level, GLuint64 size) {
   size = (level > 1) ? MipMap(k3D, size) : size;
+  if (GLuint64 bits = BitsOfCompressedFormat(format)) return bits * size / 8;
   size = SizeOfFormat(format) * size;
   return size;
 }
 
 GLuint64 MemoryUsed(Type type, GLuint64 read) {
-  GLuint64 total = 0;
-  for (const auto [obj, bytes] : gMaps[type]) {
-    total += bytes;
+  return gUsed[type].load(std::memory_order_relaxed) / read;
+}
+
+void* Allocate(Tag::Enum tag, size_t bytes, size_t alignment) {
+  if (auto hook = gAllocHook.load(std::memory_order_relaxed)) hook(bytes);
+  void* ptr = mi_malloc_aligned(bytes, alignment);
+  if (ptr) Count(tag, static_cast<int64_t>(mi_usable_size(ptr)));
+  return ptr;
+}
+
+void* Reallocate(Tag::Enum tag, void* ptr, size_t bytes) {
+  if (auto hook = gAllocHook.load(std::memory_order_relaxed)) hook(bytes);
+  int64_t old_bytes = ptr ? static_cast<int64_t>(mi_usable_size(ptr)) : 0;
+  void* new_ptr = mi_realloc(ptr, bytes);
+  if (new_ptr) {
+    Count(tag, static_cast<int64_t>(mi_usable_size(new_ptr)) - old_bytes);
+  }
+  return new_ptr;
+}
+
+void Free(Tag::Enum tag, void* ptr) {
+  if (ptr == nullptr) return;
+  Count(tag, -static_cast<int64_t>(mi_usable_size(ptr)));
+  mi_free(ptr);
+}
+
+TagStats GetTagStats(Tag::Enum tag, GLuint64 read) {
+  const auto& counter = gTags[tag];
+  auto current = counter.current.load(std::memory_order_relaxed);
+  auto peak = counter.peak.load(std::memory_order_relaxed);
+  return {static_cast<GLuint64>(std::max<int64_t>(current, 0)) / read,
+          static_cast<GLuint64>(std::max<int64_t>(peak, 0)) / read,
+          counter.allocations.load(std::memory_order_relaxed)};
+}
+
+void ResetTagPeaks() {
+  for (auto& counter : gTags) {
+    counter.peak.store(counter.current.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+  }
+}
+
+void LogTagStats() {
+  for (int tag = 0; tag < Tag::kTotal; ++tag) {
+    auto stats = GetTagStats(static_cast<Tag::Enum>(tag), kKB);
+    spdlog::info("{}: {} {} KB, peak {} KB, {} allocations", __FUNCTION__,
+                 NamedEnum<Tag::Enum>::ToStr()[tag], stats.current, stats.peak,
+                 stats.allocations);
   }
-  return total / read;
 }
 
-}  // namespace mem
\ No newline at end of file
+}  // namespace mem
@@ -2,6 +2,12 @@
 
 // deps
 #include <glad/glad.h>
+// global
+#include <cstddef>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace mem {
 
@@ -19,4 +25,66 @@ GLuint64 CalcTexBytes3D(GLenum format, GLsizei level, GLuint64 size);
 
 GLuint64 MemoryUsed(Type type, GLuint64 read);
 
-}  // namespace mem
\ No newline at end of file
+// CPU memory per subsystem, to find the owner of a peak
+struct Tag {
+  enum Enum : int { kAssets, kAnimation, kScene, kUi, kShaderCache, kTotal };
+};
+
+struct TagStats {
+  GLuint64 current{0};
+  GLuint64 peak{0};
+  GLuint64 allocations{0};
+};
+
+// mimalloc, the usable size is counted to the tag
+// nullptr if out of memory (C callbacks: stb, ImGui)
+void* Allocate(Tag::Enum tag, size_t bytes,
+               size_t alignment = alignof(std::max_align_t));
+void* Reallocate(Tag::Enum tag, void* ptr, size_t bytes);
+void Free(Tag::Enum tag, void* ptr);
+
+TagStats GetTagStats(Tag::Enum tag, GLuint64 read);
+// the peaks start again from the current usage
+void ResetTagPeaks();
+void LogTagStats();
+
+// STL allocator, e.g. TagVector<Bone, Tag::kAnimation>
+template <typename T, Tag::Enum tag>
+struct TagAllocator {
+  using value_type = T;
+  // the tag isn't a type, std::allocator_traits can't rebind it
+  template <typename U>
+  struct rebind {
+    using other = TagAllocator<U, tag>;
+  };
+
+  TagAllocator() noexcept = default;
+  template <typename U>
+  TagAllocator(const TagAllocator<U, tag>&) noexcept {}
+
+  T* allocate(size_t n) {
+    void* ptr = Allocate(tag, n * sizeof(T), alignof(T));
+    if (ptr == nullptr) throw std::bad_alloc();
+    return static_cast<T*>(ptr);
+  }
+  void deallocate(T* ptr, size_t) noexcept { Free(tag, ptr); }
+
+  template <typename U>
+  bool operator==(const TagAllocator<U, tag>&) const noexcept {
+    return true;
+  }
+};
+
+template <typename T, Tag::Enum tag>
+using TagVector = std::vector<T, TagAllocator<T, tag>>;
+
+template <typename K, typename T, Tag::Enum tag>
+using TagUnMap =
+    std::unordered_map<K, T, std::hash<K>, std::equal_to<K>,
+                       TagAllocator<std::pair<const K, T>, tag>>;
+
+template <Tag::Enum tag>
+using TagString =
+    std::basic_string<char, std::char_traits<char>, TagAllocator<char, tag>>;
+
+}  // namespace mem
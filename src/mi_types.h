@@ -3,12 +3,44 @@
 // deps
 #include <mimalloc.h>
 // global
+#include <atomic>
+#include <cstddef>
 #include <unordered_map>
 #include <vector>
 
+namespace mem {
+
+// set by prof::StartAllocTracking(), see utils/alloc_tracking.h
+inline std::atomic<void (*)(size_t)> gAllocHook = nullptr;
+
+// mi_stl_allocator visible to the allocation tracker
+template <typename T>
+struct MiAllocator {
+  using value_type = T;
+
+  MiAllocator() noexcept = default;
+  template <typename U>
+  MiAllocator(const MiAllocator<U> &) noexcept {}
+
+  T *allocate(size_t n) {
+    if (auto hook = gAllocHook.load(std::memory_order_relaxed)) {
+      hook(n * sizeof(T));
+    }
+    return static_cast<T *>(mi_new_n(n, sizeof(T)));
+  }
+  void deallocate(T *ptr, size_t) noexcept { mi_free(ptr); }
+
+  template <typename U>
+  bool operator==(const MiAllocator<U> &) const noexcept {
+    return true;
+  }
+};
+
+}  // namespace mem
+
 template <typename T>
-using MiVector = std::vector<T, mi_stl_allocator<T>>;
+using MiVector = std::vector<T, mem::MiAllocator<T>>;
 
 template <typename K, typename T>
 using MiUnMap = std::unordered_map<K, T, std::hash<K>, std::equal_to<K>,
-                                   mi_stl_allocator<std::pair<const K, T>>>;
+                                   mem::MiAllocator<std::pair<const K, T>>>;
@@ -4,10 +4,12 @@
 #include <spdlog/spdlog.h>
 // global
 #include <string>
+#include <vector>
 // local
 #include "global.h"
 #include "mem_info.h"
 #include "mi_types.h"
+#include "utils/metrics.h"
 
 // layout(std430, binding = x)
 struct ShaderStorageBinding {
@@ -47,6 +49,10 @@ struct ShaderStorageBinding {
 
 namespace gl {
 
+// glNamedBufferSubData of the buffers, the vertex and the uniform buffers
+// the only definition, one name is one slot
+inline metrics::Counter gStreamedBytes{"gpu.bytes_streamed"};
+
 struct BufferAddr {
   GLintptr element_offset;
   GLint index_offset;
@@ -91,8 +97,9 @@ class CountedBuffer : public Buffer<S> {
 
   template <typename E>
   BufferAddr AppendArray(const E* data, GLsizeiptr count);
-  template <typename E>
-  BufferAddr AppendVector(const MiVector<E>& vec);
+  // any allocator (MiVector, mem::TagVector)
+  template <typename E, typename A>
+  BufferAddr AppendVector(const std::vector<E, A>& vec);
   template <typename E>
   void UploadIndex(const E& value, GLuint index);
 
@@ -111,8 +118,8 @@ class StreamBuffer : public Buffer<S> {
 
   template <typename E, typename R>
   void UploadArray(R S::*member, const E* data, GLsizeiptr count) const;
-  template <typename E, typename R>
-  void UploadVector(R S::*member, const MiVector<E>& vec) const;
+  template <typename E, typename A, typename R>
+  void UploadVector(R S::*member, const std::vector<E, A>& vec) const;
 };
 
 template <typename S>
@@ -89,6 +89,7 @@ BufferAddr CountedBuffer<S>::AppendArray(const E* data, GLsizeiptr count) {
     GLintptr offset_bytes = sizeof(E) * element_count_;
     GLsizeiptr size_bytes = sizeof(E) * count;
     glNamedBufferSubData(vbo_, offset_bytes, size_bytes, data);
+    gStreamedBytes.Add(size_bytes);
     element_count_ += count;
     ++upload_count_;
     current_size_ += size_bytes;
@@ -100,8 +101,8 @@ BufferAddr CountedBuffer<S>::AppendArray(const E* data, GLsizeiptr count) {
 }
 
 template <typename S>
-template <typename E>
-BufferAddr CountedBuffer<S>::AppendVector(const MiVector<E>& vec) {
+template <typename E, typename A>
+BufferAddr CountedBuffer<S>::AppendVector(const std::vector<E, A>& vec) {
   GLsizeiptr count = static_cast<GLsizeiptr>(vec.size());
   GLsizeiptr new_size = sizeof(E) * (element_count_ + count);
   BufferAddr addr{element_count_, upload_count_};
@@ -109,6 +110,7 @@ BufferAddr CountedBuffer<S>::AppendVector(const MiVector<E>& vec) {
     GLintptr offset_bytes = sizeof(E) * element_count_;
     GLsizeiptr size_bytes = sizeof(E) * count;
     glNamedBufferSubData(vbo_, offset_bytes, size_bytes, vec.data());
+    gStreamedBytes.Add(size_bytes);
     element_count_ += count;
     ++upload_count_;
     current_size_ += size_bytes;
@@ -125,6 +127,7 @@ void CountedBuffer<S>::UploadIndex(const E& value, GLuint index) {
   GLsizeiptr size = sizeof(E);
   if (offset < total_size_) {
     glNamedBufferSubData(vbo_, offset, size, &value);
+    gStreamedBytes.Add(size);
   } else {
     spdlog::error("{}: Buffer '{}', index is out of range '{}'", __FUNCTION__,
                   name_, index);
@@ -141,20 +144,23 @@ void StreamBuffer<S>::UploadArray(R S::*member, const E* data,
     GLintptr offset = reinterpret_cast<GLintptr>(
         &reinterpret_cast<char const volatile&>((((S*)0)->*member)));
     glNamedBufferSubData(vbo_, offset, size, data);
+    gStreamedBytes.Add(size);
   } else {
     spdlog::error("{}: Buffer overflow '{}'", __FUNCTION__, name_);
   }
 };
 
 template <typename S>
-template <typename E, typename R>
-void StreamBuffer<S>::UploadVector(R S::*member, const MiVector<E>& vec) const {
+template <typename E, typename A, typename R>
+void StreamBuffer<S>::UploadVector(R S::*member,
+                                   const std::vector<E, A>& vec) const {
   constexpr GLsizeiptr limit = sizeof((((S*)0)->*member));
   GLsizeiptr size = sizeof(E) * static_cast<GLsizeiptr>(vec.size());
   if (size <= limit) {
     GLintptr offset = reinterpret_cast<GLintptr>(
         &reinterpret_cast<char const volatile&>((((S*)0)->*member)));
     glNamedBufferSubData(vbo_, offset, size, vec.data());
+    gStreamedBytes.Add(size);
   } else {
     spdlog::error("{}: Buffer overflow '{}'", __FUNCTION__, name_);
   }
@@ -94,7 +94,7 @@ Shader::SourceCode Shader::ParseShaderFile(const fs::path &full_path) {
   size_t first_line = 0;
   size_t last_line = view.size();
   // header
-  std::string version{""};
+  CacheString version;
   size_t version_line = view.find("#version", 0);
   if (version_line != std::string::npos) {
     // grab #version line
@@ -103,7 +103,7 @@ Shader::SourceCode Shader::ParseShaderFile(const fs::path &full_path) {
   }
   // body, process the #include directives
   const std::string_view include{"#include"};
-  std::string body{""};
+  CacheString body;
   if (view.find(include, first_line) != std::string::npos) {
     const RangeOfLines bounds{first_line, last_line};
     MiVector<RangeOfLines> inc_ranges = FindRanges(view, include, bounds);
@@ -131,7 +131,8 @@ Shader::SourceCode Shader::ParseShaderFile(const fs::path &full_path) {
           body += cache.body;
         } else {
           auto [pair, result] = shader_cache_.try_emplace(
-              include_path, std::string(), files::ReadFile(include_path));
+              include_path, CacheString(),
+              CacheString(std::string_view(files::ReadFile(include_path))));
           const auto &cache = pair->second;
           body += cache.body;
         }
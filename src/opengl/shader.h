@@ -6,6 +6,7 @@
 #include <string>
 // local
 #include "files.h"
+#include "mem_info.h"
 #include "mi_types.h"
 
 namespace gl {
@@ -33,11 +34,13 @@ class Shader {
   static void ClearShaderCache();
 
  private:
+  using CacheString = mem::TagString<mem::Tag::kShaderCache>;
   struct Cache {
-    std::string version;
-    std::string body;
+    CacheString version;
+    CacheString body;
   };
-  inline static MiUnMap<fs::path, Cache> shader_cache_;
+  inline static mem::TagUnMap<fs::path, Cache, mem::Tag::kShaderCache>
+      shader_cache_;
 
   GLuint shader_{0};
   bool IsValid(const std::string &filepath);
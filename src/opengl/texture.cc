@@ -110,6 +110,14 @@ void Texture::SubImage2D(GLint level, GLint xoffset, GLint yoffset,
                       type, pixels);
 }
 
+void Texture::CompressedSubImage2D(GLint level, GLint xoffset, GLint yoffset,
+                                   GLsizei width, GLsizei height,
+                                   GLenum format, GLsizei image_size,
+                                   const void *data) const {
+  glCompressedTextureSubImage2D(tbo_, level, xoffset, yoffset, width, height,
+                                format, image_size, data);
+}
+
 void Texture::SubImage3D(GLsizei width, GLsizei height, GLsizei depth,
                          GLenum format, GLenum type, const void *pixels) const {
   glTextureSubImage3D(tbo_, 0, 0, 0, 0, width, height, depth, format, type,
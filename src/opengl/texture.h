@@ -48,6 +48,10 @@ class Texture {
   void SubImage2D(GLint level, GLint xoffset, GLint yoffset, GLsizei width,
                   GLsizei height, GLenum format, GLenum type,
                   const void *pixels) const;
+  // format is the internal format of the storage, image_size in bytes
+  void CompressedSubImage2D(GLint level, GLint xoffset, GLint yoffset,
+                            GLsizei width, GLsizei height, GLenum format,
+                            GLsizei image_size, const void *data) const;
   void SubImage3D(GLsizei width, GLsizei height, GLsizei depth, GLenum format,
                   GLenum type, const void *pixels) const;
   void SubImage3D(GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
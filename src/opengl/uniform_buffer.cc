@@ -5,6 +5,7 @@
 // local
 #include "app/parameters.h"
 #include "global.h"
+#include "opengl/buffer_storage.h"
 
 namespace gl {
 
@@ -58,10 +59,12 @@ void *UniformBuffer::MapBufferImpl(GLsizeiptr size, GLuint binding) noexcept {
 void UniformBuffer::Upload() const {
   glNamedBufferSubData(ubo_, 0, static_cast<GLsizeiptr>(raw_memory_.size()),
                        raw_memory_.data());
+  gStreamedBytes.Add(static_cast<int64_t>(raw_memory_.size()));
 }
 
 void UniformBuffer::SubData(GLuint binding, GLsizeiptr size, void *data) const {
   glNamedBufferSubData(ubo_, offsets_[binding], size, data);
+  gStreamedBytes.Add(size);
 }
 
 }  // namespace gl
\ No newline at end of file
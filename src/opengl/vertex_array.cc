@@ -45,6 +45,12 @@ void VertexArray::EnableVertexAttrib(const VertexAttribute* attr,
                                  attr->type, 0);
       break;
     default:
+      // UNORM/SNORM, the shader reads floats
+      if (attr->normalized) {
+        glVertexArrayAttribFormat(vao_, attr->index, attr->num_of_comp,
+                                  attr->type, GL_TRUE, 0);
+        break;
+      }
       glVertexArrayAttribIFormat(vao_, attr->index, attr->num_of_comp,
                                  attr->type, 0);
       break;
@@ -4,6 +4,7 @@
 #include <spdlog/spdlog.h>
 // local
 #include "mem_info.h"
+#include "opengl/buffer_storage.h"
 
 namespace gl {
 
@@ -50,6 +51,14 @@ void CheckAttributes(Attributes& attrs) {
   }
 }
 
+GLuint GetVertexSize(const Attributes& attrs) {
+  GLuint size = 0;
+  for (const auto* attr : attrs) {
+    size += attr->stride;
+  }
+  return size;
+}
+
 VertexBuffers::VertexBuffers(const Attributes& attrs) : attrs_(attrs) {
   CheckAttributes(attrs_);
 
@@ -144,10 +153,10 @@ bool VertexBuffers::NotEnoughSpaceMt(GLuint vertex_count,
 }
 
 VertexAddr VertexBuffers::UploadVerticesIndicesMt(
-    const MiVector<void*>& vertices,  //
-    GLuint vertex_count,              //
-    void* indices,                    //
-    GLuint indice_count               //
+    const MiVector<const void*>& vertices,  //
+    GLuint vertex_count,                    //
+    const void* indices,                    //
+    GLuint indice_count                     //
 ) {
   std::scoped_lock lock(mutex_);
 
@@ -166,12 +175,14 @@ VertexAddr VertexBuffers::UploadVerticesIndicesMt(
     GLintptr offset = strides_[i] * vertex_current_count_;
     GLsizeiptr size = strides_[i] * vertex_count;
     glNamedBufferSubData(buffers_[i], offset, size, vertices[i]);
+    gStreamedBytes.Add(size);
   }
   vertex_current_count_ += vertex_count;
 
   GLintptr offset = sizeof(GLuint) * indice_current_count_;
   GLsizeiptr size = sizeof(GLuint) * indice_count;
   glNamedBufferSubData(ebo_, offset, size, indices);
+  gStreamedBytes.Add(size);
   indice_current_count_ += indice_count;
 
   sync_.EndMt();
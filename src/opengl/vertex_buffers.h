@@ -10,6 +10,7 @@
 // local
 #include "mi_types.h"
 #include "opengl/fence_sync.h"
+#include "utils/profiling.h"
 
 namespace gl {
 
@@ -37,11 +38,15 @@ struct VertexAttribute {
   GLint type;
   GLuint stride;
   GLuint divisor;
+  // integer types to [0, 1] or [-1, 1] floats (UNORM/SNORM)
+  GLboolean normalized{GL_FALSE};
 };
 
 using Attributes = MiVector<const VertexAttribute *>;
 
 void CheckAttributes(Attributes &attrs);
+// bytes of one vertex in all buffers of the attributes
+GLuint GetVertexSize(const Attributes &attrs);
 
 struct VertexAddr {
   GLuint vertex_count;
@@ -76,8 +81,8 @@ class VertexBuffers {
   GLuint GetEbo() const;
 
   bool NotEnoughSpaceMt(GLuint vertex_count, GLuint indice_count) const;
-  VertexAddr UploadVerticesIndicesMt(const MiVector<void *> &vertices,
-                                     GLuint vertex_count, void *indices,
+  VertexAddr UploadVerticesIndicesMt(const MiVector<const void *> &vertices,
+                                     GLuint vertex_count, const void *indices,
                                      GLuint indice_count);
 
  private:
@@ -91,7 +96,7 @@ class VertexBuffers {
   GLuint vertex_total_count_{0};
   GLuint indice_total_count_{0};
 
-  mutable std::mutex mutex_;
+  mutable prof::Mutex mutex_{"VertexBuffers"};
   gl::Sync sync_;
 };
 
@@ -143,6 +148,36 @@ inline const gl::VertexAttribute kTexCoordsAttr{
     .divisor = 0,                             //
 };
 
+// compact static vertices, see assets/vertex_format.h
+inline const gl::VertexAttribute kPackedNormalAttr{
+    .name = "PackedNormal",                //
+    .index = gl::VertexLocation::kNormal,  //
+    .num_of_comp = 2,                      //
+    .type = GL_SHORT,                      //
+    .stride = sizeof(GLuint),              //
+    .divisor = 0,                          //
+    .normalized = GL_TRUE,                 //
+};
+
+inline const gl::VertexAttribute kPackedTangentAttr{
+    .name = "PackedTangent",                //
+    .index = gl::VertexLocation::kTangent,  //
+    .num_of_comp = 2,                       //
+    .type = GL_SHORT,                       //
+    .stride = sizeof(GLuint),               //
+    .divisor = 0,                           //
+    .normalized = GL_TRUE,                  //
+};
+
+inline const gl::VertexAttribute kHalfTexCoordsAttr{
+    .name = "HalfTexCoords",                  //
+    .index = gl::VertexLocation::kTexCoords,  //
+    .num_of_comp = 2,                         //
+    .type = GL_HALF_FLOAT,                    //
+    .stride = sizeof(GLuint),                 //
+    .divisor = 0,                             //
+};
+
 inline const gl::VertexAttribute kVertexColorAttr{
     .name = "VertexColor",                      //
     .index = gl::VertexLocation::kVertexColor,  //
@@ -170,6 +205,26 @@ inline const gl::VertexAttribute kWeightsAttr{
     .divisor = 0,                           //
 };
 
+// compact skinned vertices, see assets/vertex_format.h
+inline const gl::VertexAttribute kPackedBonesAttr{
+    .name = "PackedBones",                //
+    .index = gl::VertexLocation::kBones,  //
+    .num_of_comp = 4,                     //
+    .type = GL_SHORT,                     //
+    .stride = 4 * sizeof(GLshort),        //
+    .divisor = 0,                         //
+};
+
+inline const gl::VertexAttribute kPackedWeightsAttr{
+    .name = "PackedWeights",                //
+    .index = gl::VertexLocation::kWeights,  //
+    .num_of_comp = 4,                       //
+    .type = GL_UNSIGNED_BYTE,               //
+    .stride = 4 * sizeof(GLubyte),          //
+    .divisor = 0,                           //
+    .normalized = GL_TRUE,                  //
+};
+
 inline const gl::VertexAttribute kInstanceAttr{
     .name = "InstanceAttr",                      //
     .index = gl::VertexLocation::kInstanceAttr,  //
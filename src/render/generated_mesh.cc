@@ -78,25 +78,26 @@ void GeneratedMesh::CalcTangents(VertexDataStatic& data) {
 
 void GeneratedMesh::UploadMeshInternal(VertexDataInternal& data,
                                        GenMeshInternal::Enum type) {
-  MiVector<void*> upload = {static_cast<void*>(data.positions.data())};
+  MiVector<const void*> upload = {
+      static_cast<const void*>(data.positions.data())};
   GLuint vertex_count = static_cast<GLuint>(data.positions.size());
   GLuint indice_count = static_cast<GLuint>(data.indices.size());
   addr_internal_[type] = mesh_internal_.UploadVerticesIndicesMt(
-      upload, vertex_count, static_cast<void*>(data.indices.data()),
+      upload, vertex_count, static_cast<const void*>(data.indices.data()),
       indice_count);
 }
 
 void GeneratedMesh::UploadMeshStatic(VertexDataStatic& data,
                                      GenMeshStatic::Enum type) {
-  MiVector<void*> upload = {
-      static_cast<void*>(data.positions.data()),
-      static_cast<void*>(data.normals.data()),
-      static_cast<void*>(data.tex_coords.data()),
+  MiVector<const void*> upload = {
+      static_cast<const void*>(data.positions.data()),
+      static_cast<const void*>(data.normals.data()),
+      static_cast<const void*>(data.tex_coords.data()),
   };
   GLuint vertex_count = static_cast<GLuint>(data.positions.size());
   GLuint indice_count = static_cast<GLuint>(data.indices.size());
   addr_static_[type] = mesh_static_.UploadVerticesIndicesMt(
-      upload, vertex_count, static_cast<void*>(data.indices.data()),
+      upload, vertex_count, static_cast<const void*>(data.indices.data()),
       indice_count);
 }
 
@@ -1,5 +1,10 @@
 #include "renderer.h"
 
+// deps
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+// global
+#include <fstream>
 // local
 #include "app/input.h"
 #include "app/parameters.h"
@@ -9,6 +14,24 @@
 #include "math/random.h"
 #include "options.h"
 #include "scene/scene.h"
+#include "utils/enums.h"
+#include "utils/metrics.h"
+#include "utils/profiling.h"
+
+namespace {
+
+// the readback of gpu::StorageAtomicCounters, the previous frame
+struct CullingGauges {
+  metrics::Gauge instances{"scene.instances"};
+  metrics::Gauge view_frustum{"gpu.frustum_instances_view"};
+  metrics::Gauge view_occlusion{"gpu.occlusion_instances_view"};
+  metrics::Gauge direct_shadows{"gpu.frustum_instances_direct_shadows"};
+  metrics::Gauge point_shadows{"gpu.frustum_instances_point_shadows"};
+  metrics::Gauge point_lights{"gpu.frustum_point_lights"};
+  metrics::Gauge point_shadow_lights{"gpu.frustum_point_shadows"};
+} gCulling;
+
+}  // namespace
 
 Renderer::Renderer(Assets& assets,            //
                    Scene& scene,              //
@@ -284,21 +307,49 @@ void Renderer::BindDefaultFramebuffer() {
 
 void Renderer::ProcessMetrics() {
   auto& p = profiling_;
-  // ProcessMetrics
-  if (p.frame_accum == 20) {
-    p.total_time = 0.0;
-    for (int q = 0; q < Metrics::kTotal; ++q) {
-      p.time[q] = p.accum[q] / 20.0;
-      p.accum[q] = 0.0;
-      p.total_time += p.time[q];
-    }
-    p.frame_accum = 0;
-  } else {
-    for (int q = 0; q < Metrics::kTotal; ++q) {
-      p.accum[q] += queries_[q].GetResultAsTime();
-    }
+  // the results of the previous frame
+  double total_time = 0.0;
+  for (int q = 0; q < Metrics::kTotal; ++q) {
+    double time = queries_[q].GetResultAsTime();
+    p.gpu[q].Add(static_cast<float>(time));
+    total_time += time;
+  }
+  p.gpu_total.Add(static_cast<float>(total_time));
+
+  const auto& count = *atomic_counters_;
+  gCulling.instances.Set(scene_.instance_count_);
+  gCulling.view_frustum.Set(count.frustum_instances_view);
+  gCulling.view_occlusion.Set(count.occlusion_instances_view);
+  gCulling.direct_shadows.Set(count.frustum_instances_direct_shadows);
+  gCulling.point_shadows.Set(count.frustum_instances_point_shadows);
+  gCulling.point_lights.Set(count.frustum_point_lights);
+  gCulling.point_shadow_lights.Set(count.frustum_point_shadows);
+}
+
+bool Renderer::SaveMetricsCsv(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (!file) {
+    spdlog::error("{}: Failed to open '{}'", __FUNCTION__, filename);
+    return false;
+  }
+
+  auto write = [&file](const char* stage, const char* side,
+                       const prof::RollingHistogram& histogram) {
+    auto p = histogram.GetPercentiles();
+    file << fmt::format("{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f}\n", stage,
+                        side, p.p50, p.p95, p.p99, p.max, p.avg);
+  };
+  const auto& p = profiling_;
+  file << "stage,side,p50_ms,p95_ms,p99_ms,max_ms,avg_ms\n";
+  for (int q = 0; q < CpuMetrics::kTotal; ++q) {
+    write(NamedEnum<CpuMetrics::Enum>::ToStr()[q], "cpu", p.cpu[q]);
   }
-  ++p.frame_accum;
+  for (int q = 0; q < Metrics::kTotal; ++q) {
+    write(NamedEnum<Metrics::Enum>::ToStr()[q], "gpu", p.gpu[q]);
+  }
+  write("Total", "gpu", p.gpu_total);
+  spdlog::info("{}: Saved to '{}'", __FUNCTION__, filename);
+  return true;
 }
 
 void Renderer::BuildIndirectCmd() {
@@ -1156,10 +1207,17 @@ void Renderer::RenderLoading() {
 
 void Renderer::RenderScene() {
   using enum Metrics::Enum;
+  // CPU side: command submission and the syncs with GPU
+  prof::Zone zone("Renderer::RenderScene");
   ProcessMetrics();
 
   // scene (models, objects, lights, etc.)
+  prof::Counter stage;
   scene_.ProcessScene();
+  stage.End();
+  profiling_.cpu[CpuMetrics::kProcessScene].Add(
+      stage.GetTime<prof::fms>());
+  stage.Start();
   // UBO for Renderer
   ubo_.UploadBuffers();
   // after UBO (compute shader)
@@ -1281,9 +1339,12 @@ void Renderer::RenderScene() {
 
   // pick object and light at crosshair,
   // gather renderpasses data (ui, debug)
-  sync_.FenceSt();
-  scene_.PickEntity();
-  scene_.objects_.ReadVisibility();
+  {
+    prof::Zone sync("Fence, Pick, Visibility");
+    sync_.FenceSt();
+    scene_.PickEntity();
+    scene_.objects_.ReadVisibility();
+  }
 
   // after all visibility tests
   queries_[kOutlineSelectedTexture].Begin();
@@ -1423,4 +1484,6 @@ void Renderer::RenderScene() {
 
   // debug
   ViewLayers();
+  profiling_.cpu[CpuMetrics::kRenderSubmission].Add(
+      stage.GetElapsed<prof::fms>());
 }
\ No newline at end of file
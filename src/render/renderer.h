@@ -15,6 +15,7 @@
 #include "render/uniform_buffers.h"
 #include "render/vertex_arrays.h"
 #include "ui/win_layout.h"
+#include "utils/profiling.h"
 // fwd
 class Assets;
 class Scene;
@@ -171,6 +172,20 @@ struct Metrics {
   };
 };
 
+// CPU side of the frame (main thread)
+struct CpuMetrics {
+  enum Enum : unsigned int {
+    // frame to frame
+    kFrame,
+    kInput,
+    kUi,
+    kProcessScene,
+    // RenderScene() without ProcessScene()
+    kRenderSubmission,
+    kTotal
+  };
+};
+
 class Renderer : public event::Base<Renderer> {
  public:
   friend class ui::WinScene;
@@ -184,13 +199,15 @@ class Renderer : public event::Base<Renderer> {
                           ParticleSystem&);
 
  public:
+  // milliseconds per frame, percentiles catch the stutters
   struct ProfilingQueries {
-    int frame_accum{0};
-    double accum[Metrics::kTotal]{};
-    double time[Metrics::kTotal]{};
-    double total_time{};
+    prof::RollingHistogram gpu[Metrics::kTotal];
+    prof::RollingHistogram gpu_total;
+    prof::RollingHistogram cpu[CpuMetrics::kTotal];
   };
   ProfilingQueries profiling_;
+  // stage,side,p50,p95,p99,max,avg
+  bool SaveMetricsCsv(const std::string& filename) const;
 
   void RenderLoading();
   void RenderScene();
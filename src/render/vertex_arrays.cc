@@ -1,10 +1,20 @@
 #include "vertex_arrays.h"
 
+// local
+#include "app/parameters.h"
+
 VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
                            gl::VertexBuffers& mesh_static,        //
                            gl::VertexBuffers& mesh_skinned,       //
                            GLuint instance_attributes,            //
                            GLuint instance_matrix_mvp) {
+  // compact vertices (ModelManager), see assets/vertex_format.h
+  const bool compact = app::cpu.compact_vertices;
+  const auto* static_tex_coords =
+      compact ? &kHalfTexCoordsAttr : &kTexCoordsAttr;
+  const auto* skin_bones = compact ? &kPackedBonesAttr : &kBonesAttr;
+  const auto* skin_weights = compact ? &kPackedWeightsAttr : &kWeightsAttr;
+
   genmesh_pos_inst.SetAttributes({
       &kPositionAttr,  //
       &kInstanceAttr   //
@@ -23,8 +33,8 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
 
   pos_skin_inst.SetAttributes({
       &kPositionAttr,  //
-      &kBonesAttr,     //
-      &kWeightsAttr,   //
+      skin_bones,      //
+      skin_weights,    //
       &kInstanceAttr   //
   });
   pos_skin_inst.SetVertexBuffers(mesh_skinned);
@@ -32,9 +42,9 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
   pos_skin_inst.AttachBuffers();
 
   pos_tex_inst.SetAttributes({
-      &kPositionAttr,   //
-      &kTexCoordsAttr,  //
-      &kInstanceAttr    //
+      &kPositionAttr,     //
+      static_tex_coords,  //
+      &kInstanceAttr      //
   });
   pos_tex_inst.SetVertexBuffers(mesh_static);
   pos_tex_inst.SetBuffer(&kInstanceAttr, instance_attributes);
@@ -43,8 +53,8 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
   pos_tex_skin_inst.SetAttributes({
       &kPositionAttr,   //
       &kTexCoordsAttr,  //
-      &kBonesAttr,      //
-      &kWeightsAttr,    //
+      skin_bones,       //
+      skin_weights,     //
       &kInstanceAttr    //
   });
   pos_tex_skin_inst.SetVertexBuffers(mesh_skinned);
@@ -63,8 +73,8 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
 
   pos_skin_inst_mvp.SetAttributes({
       &kPositionAttr,   //
-      &kBonesAttr,      //
-      &kWeightsAttr,    //
+      skin_bones,       //
+      skin_weights,     //
       &kInstanceAttr,   //
       &kInstanceMatrix  //
   });
@@ -74,10 +84,10 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
   pos_skin_inst_mvp.AttachBuffers();
 
   pos_tex_inst_mvp.SetAttributes({
-      &kPositionAttr,   //
-      &kTexCoordsAttr,  //
-      &kInstanceAttr,   //
-      &kInstanceMatrix  //
+      &kPositionAttr,     //
+      static_tex_coords,  //
+      &kInstanceAttr,     //
+      &kInstanceMatrix    //
   });
   pos_tex_inst_mvp.SetVertexBuffers(mesh_static);
   pos_tex_inst_mvp.SetBuffer(&kInstanceAttr, instance_attributes);
@@ -87,8 +97,8 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
   pos_tex_skin_inst_mvp.SetAttributes({
       &kPositionAttr,   //
       &kTexCoordsAttr,  //
-      &kBonesAttr,      //
-      &kWeightsAttr,    //
+      skin_bones,       //
+      skin_weights,     //
       &kInstanceAttr,   //
       &kInstanceMatrix  //
   });
@@ -97,15 +107,27 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
   pos_tex_skin_inst_mvp.SetBuffer(&kInstanceMatrix, instance_matrix_mvp);
   pos_tex_skin_inst_mvp.AttachBuffers();
 
-  pos_norm_tex_inst_mvp.SetAttributes({
-      &kPositionAttr,   //
-      &kNormalAttr,     //
-      &kTangentAttr,    //
-      &kBitangentAttr,  //
-      &kTexCoordsAttr,  //
-      &kInstanceAttr,   //
-      &kInstanceMatrix  //
-  });
+  if (compact) {
+    // the bitangent is reconstructed, see shaders/vertex.glsl
+    pos_norm_tex_inst_mvp.SetAttributes({
+        &kPositionAttr,       //
+        &kPackedNormalAttr,   //
+        &kPackedTangentAttr,  //
+        &kHalfTexCoordsAttr,  //
+        &kInstanceAttr,       //
+        &kInstanceMatrix      //
+    });
+  } else {
+    pos_norm_tex_inst_mvp.SetAttributes({
+        &kPositionAttr,   //
+        &kNormalAttr,     //
+        &kTangentAttr,    //
+        &kBitangentAttr,  //
+        &kTexCoordsAttr,  //
+        &kInstanceAttr,   //
+        &kInstanceMatrix  //
+    });
+  }
   pos_norm_tex_inst_mvp.SetVertexBuffers(mesh_static);
   pos_norm_tex_inst_mvp.SetBuffer(&kInstanceAttr, instance_attributes);
   pos_norm_tex_inst_mvp.SetBuffer(&kInstanceMatrix, instance_matrix_mvp);
@@ -117,8 +139,8 @@ VertexArrays::VertexArrays(gl::VertexBuffers& gen_mesh_internal,  //
       &kTangentAttr,    //
       &kBitangentAttr,  //
       &kTexCoordsAttr,  //
-      &kBonesAttr,      //
-      &kWeightsAttr,    //
+      skin_bones,       //
+      skin_weights,     //
       &kInstanceAttr,   //
       &kInstanceMatrix  //
   });
@@ -0,0 +1,49 @@
+#pragma once
+
+// global
+#include <span>
+// local
+#include "app/parallel.h"
+#include "scene/object_system.h"
+
+// CPU part of ObjectSystem::UploadObjectsToGpu, no OpenGL (benchmarks)
+// a gpu::Instance per mesh, every object writes to its own range in parallel
+// T provides GetId(), GetProps(), GetAddr(), GetTransformation()
+// and GetModel().meshes_ with the buffer indices set by ModelManager
+template <typename T>
+void BatchInstances(std::span<T *const> objects, SceneVector<GLuint> &offsets,
+                    SceneVector<gpu::Instance> &instances,
+                    SceneVector<glm::mat4> &matrices) {
+  // prefix sum, the first instance of every object
+  offsets.resize(objects.size());
+  GLuint instance_count = 0;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    offsets[i] = instance_count;
+    instance_count += objects[i]->GetAddr().instance_count;
+  }
+  instances.resize(instance_count);
+  matrices.resize(objects.size());
+
+  app::task::ParallelFor(objects.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const auto *obj = objects[i];
+      const auto &meshes = obj->GetModel().meshes_;
+      const auto &addr = obj->GetAddr();
+      auto *instance = &instances[offsets[i]];
+      for (GLuint index = 0; const auto &mesh : meshes) {
+        GLuint box_index = addr.first_box_index + index;
+        *instance++ = gpu::Instance{obj->GetId(),                   //
+                                    obj->GetProps(),                //
+                                    mesh.packed_cmd_buffer_index_,  //
+                                    addr.matrix_index,              //
+                                    mesh.material_buffer_index_,    //
+                                    addr.animation_index,           //
+                                    box_index                       //
+        };
+        ++index;
+      }
+
+      matrices[i] = obj->GetTransformation();
+    }
+  });
+}
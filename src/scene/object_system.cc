@@ -5,8 +5,17 @@
 // global
 #include <numeric>
 // local
+#include "app/parallel.h"
 #include "app/parameters.h"
 #include "assets/model_manager.h"
+#include "scene/instance_batch.h"
+#include "utils/metrics.h"
+
+namespace {
+
+metrics::Counter gUploaded{"scene.instances_uploaded"};
+
+}  // namespace
 
 Object::Object(id::Object id, Model &model)
     : id_(id),
@@ -77,6 +86,8 @@ ObjectSystem::ObjectSystem(ModelManager &models) noexcept : models_(models) {
   objects_.reserve(1028);
   animated_objects_.reserve(global::kMaxAnimatedActors / 2);
   upload_queue_.reserve(1028);
+  objects_list_.reserve(1028);
+  animated_list_.reserve(global::kMaxAnimatedActors / 2);
 
   upload_bone_mat_.reserve(global::kMaxBoneMatrices / 16);
 
@@ -130,12 +141,14 @@ Object *ObjectSystem::CreateObject(const std::string &model_name) {
   if (model->HasAnimations()) {
     auto [it, res] = animated_objects_.try_emplace(id, id, *model);
     object = &it->second;
+    animated_list_.push_back(&it->second);
     TrackAnimatedObject(object);
   } else {
     auto [it, res] = objects_.try_emplace(id, id, *model);
     object = &it->second;
     TrackObject(object);
   }
+  objects_list_.push_back(object);
   upload_queue_.push_back(object);
 
   return object;
@@ -150,7 +163,9 @@ void ObjectSystem::DeleteObject(Object &object) {
                             GL_UNSIGNED_INT, &global::kZero4Bytes);
   instance_deleted_ += addr.instance_count;
   // CPU
+  std::erase(objects_list_, &object);
   if (object.IsAnimated()) {
+    std::erase(animated_list_, static_cast<AnimatedObject *>(&object));
     animated_objects_.erase(object.GetId());
   } else {
     objects_.erase(object.GetId());
@@ -174,51 +189,38 @@ void ObjectSystem::UpdateObject(Object &object) {
 void ObjectSystem::UploadObjectsToGpu() noexcept {
   if (upload_queue_.size() == 0) return;
 
-  upload_instances_.clear();
-  upload_matrices_.clear();
-
   // ProcessAnimation, access via addr
   upload_bone_mat_.resize(track_animation_);
   upload_skinned_boxes_.resize(track_skinned_box_);
 
-  for (const auto *obj : upload_queue_) {
-    const auto &meshes = obj->GetModel().meshes_;
-    const auto &addr = obj->GetAddr();
-    for (GLuint index = 0; const auto &mesh : meshes) {
-      GLuint box_index = addr.first_box_index + index;
-      upload_instances_.emplace_back(obj->GetId(),                   //
-                                     obj->GetProps(),                //
-                                     mesh.packed_cmd_buffer_index_,  //
-                                     addr.matrix_index,              //
-                                     mesh.material_buffer_index_,    //
-                                     addr.animation_index,           //
-                                     box_index                       //
-      );
-      ++index;
-    }
-
-    upload_matrices_.push_back(obj->GetTransformation());
-  }
+  BatchInstances(std::span<Object *const>(upload_queue_), upload_offsets_,
+                 upload_instances_, upload_matrices_);
 
   instances_.AppendVector(upload_instances_);
   matrices_.AppendVector(upload_matrices_);
+  gUploaded.Add(static_cast<int64_t>(upload_instances_.size()));
 
   upload_queue_.clear();
 }
 
 void ObjectSystem::ProcessAnimations() noexcept {
-  for (auto &[id, obj] : animated_objects_) {
-    const auto &addr = obj.GetAddr();
-    auto first_mat = upload_bone_mat_.begin() + addr.animation_index;
-    std::span<glm::mat4> bone_mat{first_mat, obj.GetNumOfBones()};
-    obj.PlayAnimation(bone_mat);
-
-    // bounding boxes, precomputed for each keyframe
-    for (GLuint i = 0; i < addr.instance_count; ++i) {
-      GLuint box_index = addr.first_box_index + i;
-      upload_skinned_boxes_[box_index] = obj.GetCurrentBox(i);
+  // disjoint ranges of bones and boxes per object
+  app::task::ParallelFor(animated_list_.size(), [this](size_t begin,
+                                                       size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      auto &obj = *animated_list_[index];
+      const auto &addr = obj.GetAddr();
+      auto first_mat = upload_bone_mat_.begin() + addr.animation_index;
+      std::span<glm::mat4> bone_mat{first_mat, obj.GetNumOfBones()};
+      obj.PlayAnimation(bone_mat);
+
+      // bounding boxes, precomputed for each keyframe
+      for (GLuint i = 0; i < addr.instance_count; ++i) {
+        GLuint box_index = addr.first_box_index + i;
+        upload_skinned_boxes_[box_index] = obj.GetCurrentBox(i);
+      }
     }
-  }
+  }, 0, app::task::Priority::kFrame);
 
   animations_.UploadVector(&gpu::StorageAnimations::bone_matrices,
                            upload_bone_mat_);
@@ -236,20 +238,17 @@ GLuint ObjectSystem::GetInstanceDeleted() const { return instance_deleted_; }
 
 void ObjectSystem::ReadVisibility() {
   auto it = std::begin(visibility_->instance_visibility);
-  for (auto &[id, obj] : objects_) {
-    const auto &addr = obj.GetAddr();
-    auto begin = it + addr.first_instance_index;
-    auto end = it + addr.first_instance_index + addr.instance_count;
-    GLuint visibility = std::accumulate(begin, end, 0);
-    obj.SetProps(Props::kVisible, visibility);
-  }
-  for (auto &[id, obj] : animated_objects_) {
-    const auto &addr = obj.GetAddr();
-    auto begin = it + addr.first_instance_index;
-    auto end = it + addr.first_instance_index + addr.instance_count;
-    GLuint visibility = std::accumulate(begin, end, 0);
-    obj.SetProps(Props::kVisible, visibility);
-  }
+  app::task::ParallelFor(objects_list_.size(), [this, it](size_t begin,
+                                                          size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      auto &obj = *objects_list_[i];
+      const auto &addr = obj.GetAddr();
+      auto first = it + addr.first_instance_index;
+      auto last = first + addr.instance_count;
+      GLuint visibility = std::accumulate(first, last, 0);
+      obj.SetProps(Props::kVisible, visibility);
+    }
+  }, 0, app::task::Priority::kFrame);
 }
 
 MiUnMap<id::Model, unsigned int> ObjectSystem::CalcObjectsPerModel() noexcept {
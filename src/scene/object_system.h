@@ -5,6 +5,7 @@
 // local
 #include "global.h"
 #include "id_generator.h"
+#include "mem_info.h"
 #include "opengl/buffer_storage.h"
 #include "scene/props.h"
 // fwd
@@ -58,6 +59,12 @@ struct StorageAnimations {
 
 }  // namespace gpu
 
+// objects and their upload arrays grow with the scene
+template <typename T>
+using SceneVector = mem::TagVector<T, mem::Tag::kScene>;
+template <typename K, typename T>
+using SceneUnMap = mem::TagUnMap<K, T, mem::Tag::kScene>;
+
 // allows to generate multiple gpu::Instance from one struct
 struct ObjectAddr {
   GLuint instance_count;
@@ -152,15 +159,20 @@ class ObjectSystem {
   void TrackObject(Object* object);
   void TrackAnimatedObject(Object* object);
 
-  MiUnMap<id::Object, Object> objects_;
-  MiUnMap<id::Object, AnimatedObject> animated_objects_;
+  SceneUnMap<id::Object, Object> objects_;
+  SceneUnMap<id::Object, AnimatedObject> animated_objects_;
+  // flat copies of the maps (stable pointers) for parallel loops
+  SceneVector<Object*> objects_list_;
+  SceneVector<AnimatedObject*> animated_list_;
   // Setup stage changes data, delay upload
-  MiVector<Object*> upload_queue_;
+  SceneVector<Object*> upload_queue_;
 
-  MiVector<glm::mat4> upload_matrices_;
-  MiVector<gpu::Instance> upload_instances_;
+  SceneVector<glm::mat4> upload_matrices_;
+  SceneVector<gpu::Instance> upload_instances_;
+  // first instance of every queued object inside upload_instances_
+  SceneVector<GLuint> upload_offsets_;
 
   // animations
-  MiVector<glm::mat4> upload_bone_mat_;
-  MiVector<gpu::AABB> upload_skinned_boxes_;
+  SceneVector<glm::mat4> upload_bone_mat_;
+  SceneVector<gpu::AABB> upload_skinned_boxes_;
 };
\ No newline at end of file
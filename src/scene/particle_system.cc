@@ -3,6 +3,7 @@
 // deps
 #include <spdlog/spdlog.h>
 // local
+#include "app/parallel.h"
 #include "assets/particle_manager.h"
 #include "math/intersection.h"
 #include "scene/camera_system.h"
@@ -26,6 +27,8 @@ ParticleSystem::ParticleSystem(ParticleManager &particles,
   fx_to_draw_.reserve(global::kMaxFxPresets);
   upload_fx_instances_.reserve(global::kMaxFxInstances);
   upload_fx_boxes_.reserve(global::kMaxFxInstances);
+  process_instances_.reserve(global::kMaxFxInstances);
+  process_culled_.reserve(global::kMaxFxInstances);
   instances_.reserve(16);
 }
 
@@ -43,28 +46,32 @@ FxInstance *ParticleSystem::ProcessParticles() noexcept {
   upload_fx_instances_.clear();
   upload_fx_boxes_.clear();
 
-  FxInstance *look_at = nullptr;
-  float closest = 0.0f;
+  process_instances_.clear();
   for (auto &[id, instance] : instances_) {
-    const FxPreset *fx = instance.fx;
-    const gpu::FxInstance &particles = instance.particles;
-    fx_to_draw_.insert(fx);
-
-    // move box, full transformation excessive
-    AABB box = fx->box;
-    const glm::vec3 &pos = particles.emitter_pos;
-    const glm::vec3 expand{particles.particle_size_min_max.y * 0.5f};
-    box.MoveAndResize(pos, expand);
-
-    if (math::AABBInFrustum(box, camera_.frustum_)) {
-      // two triangles as quad
-      draw_cmd_.emplace_back(6,                     // count
-                             fx->num_of_particles,  // instance_count
-                             0,                     // first_index
-                             fx->buffer_offset      // base_instance
-      );
-      upload_fx_instances_.push_back(particles);
-      upload_fx_boxes_.emplace_back(box.center_, box.extent_);
+    process_instances_.push_back(&instance);
+  }
+  process_culled_.resize(process_instances_.size());
+
+  // instance and LdotR, the bigger LdotR, the closer crosshair to box's center
+  using LookAt = std::pair<FxInstance *, float>;
+  // few instances, usually inline
+  constexpr size_t kCullGrain = 32;
+  auto cull = [this](size_t begin, size_t end) {
+    LookAt look_at{nullptr, 0.0f};
+    for (size_t i = begin; i < end; ++i) {
+      FxInstance &instance = *process_instances_[i];
+      const FxPreset *fx = instance.fx;
+      const gpu::FxInstance &particles = instance.particles;
+
+      // move box, full transformation excessive
+      AABB box = fx->box;
+      const glm::vec3 &pos = particles.emitter_pos;
+      const glm::vec3 expand{particles.particle_size_min_max.y * 0.5f};
+      box.MoveAndResize(pos, expand);
+
+      bool visible = math::AABBInFrustum(box, camera_.frustum_);
+      process_culled_[i] = FxCulled{box, visible};
+      if (visible == false) continue;
 
       // look at particles
       float dist = 0.0f;
@@ -73,15 +80,40 @@ FxInstance *ParticleSystem::ProcessParticles() noexcept {
             glm::normalize(box.center_ - camera_.ray_.origin_);
         float LdotR = glm::dot(dir_to_box, camera_.ray_.dir_);
         // drop boxes behind camera
-        if (LdotR > 0.0f) {
-          // the bigger LdotR, the closer crosshair to box's center
-          if (LdotR >= closest) {
-            look_at = &instance;
-            closest = LdotR;
-          }
+        if (LdotR > 0.0f && LdotR >= look_at.second) {
+          look_at = {&instance, LdotR};
         }
       }
     }
+    return look_at;
+  };
+  // the later chunk wins a tie (as the serial loop)
+  auto closest = [](const LookAt &a, const LookAt &b) {
+    return (b.first && b.second >= a.second) ? b : a;
+  };
+  FxInstance *look_at =
+      app::task::ParallelReduce(process_instances_.size(), LookAt{}, cull,
+                                closest, kCullGrain,
+                                app::task::Priority::kFrame)
+          .first;
+
+  for (size_t i = 0; i < process_instances_.size(); ++i) {
+    const FxInstance &instance = *process_instances_[i];
+    const FxPreset *fx = instance.fx;
+    // the hidden presets keep simulating (Renderer::ParticlesUpdate)
+    fx_to_draw_.insert(fx);
+
+    const auto &[box, visible] = process_culled_[i];
+    if (visible == false) continue;
+
+    // two triangles as quad
+    draw_cmd_.emplace_back(6,                     // count
+                           fx->num_of_particles,  // instance_count
+                           0,                     // first_index
+                           fx->buffer_offset      // base_instance
+    );
+    upload_fx_instances_.push_back(instance.particles);
+    upload_fx_boxes_.emplace_back(box.center_, box.extent_);
   }
   fx_instance_count_ = static_cast<GLuint>(upload_fx_instances_.size());
 
@@ -7,6 +7,7 @@
 #include "global.h"
 #include "id_generator.h"
 #include "math/collision_types.h"
+#include "mi_types.h"
 #include "opengl/buffer_storage.h"
 // fwd
 class ParticleManager;
@@ -57,8 +58,8 @@ struct FxInstance {
 };
 
 template <typename T>
-using MiUnSet =
-    std::unordered_set<T, std::hash<T>, std::equal_to<T>, mi_stl_allocator<T>>;
+using MiUnSet = std::unordered_set<T, std::hash<T>, std::equal_to<T>,
+                                  mem::MiAllocator<T>>;
 
 class ParticleSystem : public event::Base<ParticleSystem> {
  public:
@@ -98,5 +99,13 @@ class ParticleSystem : public event::Base<ParticleSystem> {
   MiVector<gpu::FxInstance> upload_fx_instances_;
   MiVector<gpu::AABB> upload_fx_boxes_;
 
+  // culled in parallel, compacted in the same order
+  struct FxCulled {
+    AABB box;
+    bool visible;
+  };
+  MiVector<FxInstance *> process_instances_;
+  MiVector<FxCulled> process_culled_;
+
   void InitEvents();
 };
\ No newline at end of file
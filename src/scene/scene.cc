@@ -8,6 +8,7 @@
 // local
 #include "assets/assets.h"
 #include "math/random.h"
+#include "utils/profiling.h"
 
 Scene::Scene(CameraSystem &cameras,      //
              ObjectSystem &objects,      //
@@ -133,14 +134,24 @@ void Scene::PlaceInAir(const std::string &name, int count, float area,
 }
 
 void Scene::ProcessScene() noexcept {
-  // batch upload when loaded/created
-  assets_.models_.UploadCmdBoxMaterial();
-  objects_.UploadObjectsToGpu();
-  lights_.UploadPointLightsToGpu();
+  prof::Zone zone("Scene::ProcessScene");
+  {
+    // batch upload when loaded/created
+    prof::Zone upload("Upload");
+    assets_.models_.UploadCmdBoxMaterial();
+    objects_.UploadObjectsToGpu();
+    lights_.UploadPointLightsToGpu();
+  }
 
   camera_.Update();
-  objects_.ProcessAnimations();
-  look_at_fx_instance_ = particles_.ProcessParticles();
+  {
+    prof::Zone animations("Animations");
+    objects_.ProcessAnimations();
+  }
+  {
+    prof::Zone particles("Particles");
+    look_at_fx_instance_ = particles_.ProcessParticles();
+  }
 
   object_count_ = objects_.GetObjectCount();
   instance_count_ = objects_.GetInstanceCount();
@@ -4,14 +4,19 @@
 #include <imgui.h>
 // local
 #include "app/ini.h"
+#include "app/main_thread.h"
 #include "app/parameters.h"
+#include "app/task_system.h"
 #include "events.h"
 #include "imgui_toggle/imgui_toggle.h"
 #include "mem_info.h"
 #include "options.h"
 #include "render/renderer.h"
 #include "ui/base_components.h"
+#include "utils/alloc_tracking.h"
 #include "utils/enums.h"
+#include "utils/metrics.h"
+#include "utils/profiling.h"
 
 namespace ui {
 
@@ -395,23 +400,145 @@ void WinSettings::ShowLayers() {
 }
 
 void WinSettings::ShowMetrics() {
-  const auto& prof = renderer_->profiling_;
+  const auto& metrics = renderer_->profiling_;
 
   const ImGuiTableFlags flags{ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg};
-  if (ImGui::BeginTable("table", 2, flags)) {
-    ImGui::TableSetupColumn("Stage");
-    ImGui::TableSetupColumn("Time");
+  auto show_row = [](const char* stage,
+                     const prof::RollingHistogram& histogram) {
+    auto p = histogram.GetPercentiles();
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::Text("%s", stage);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", p.p50);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", p.p95);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", p.p99);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.3f", p.max);
+  };
+  auto setup_columns = [](const char* side) {
+    ImGui::TableSetupColumn(side);
+    ImGui::TableSetupColumn("p50 ms");
+    ImGui::TableSetupColumn("p95 ms");
+    ImGui::TableSetupColumn("p99 ms");
+    ImGui::TableSetupColumn("max ms");
+    ImGui::TableHeadersRow();
+  };
+  if (ImGui::BeginTable("cpu", 5, flags)) {
+    setup_columns("CPU Stage");
+    for (size_t row = 0; row < CpuMetrics::kTotal; row++) {
+      show_row(NamedEnum<CpuMetrics::Enum>::ToStr()[row], metrics.cpu[row]);
+    }
+    ImGui::EndTable();
+  }
+  if (ImGui::BeginTable("gpu", 5, flags)) {
+    setup_columns("GPU Stage");
+    for (size_t row = 0; row < Metrics::kTotal; row++) {
+      show_row(NamedEnum<Metrics::Enum>::ToStr()[row], metrics.gpu[row]);
+    }
+    show_row("Total", metrics.gpu_total);
+    ImGui::EndTable();
+  }
+  ImGui::Text("Last %zu frames", metrics.gpu_total.GetCount());
+  ImGui::SameLine();
+  if (ImGui::Button("Save CSV##metrics")) {
+    renderer_->SaveMetricsCsv("metrics.csv");
+  }
+
+  ImGui::Separator();
+  ImGui::Text("Counters");
+  static MiVector<metrics::Value> values;
+  metrics::GetValues(values);
+  if (ImGui::BeginTable("counters", 2, flags)) {
+    ImGui::TableSetupColumn("Metric");
+    ImGui::TableSetupColumn("Value");
+    ImGui::TableHeadersRow();
+    for (const auto& value : values) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", value.name);
+      ImGui::TableNextColumn();
+      ImGui::Text("%lld", static_cast<long long>(value.value));
+    }
+    ImGui::EndTable();
+  }
+  if (ImGui::SliderInt("Interval##counters", &app::set::cpu.metrics_interval,
+                       1, 600, "%d frames")) {
+    metrics::SetSampleInterval(app::cpu.metrics_interval);
+  }
+  ImGui::Text("%zu samples", metrics::GetSampleCount());
+  ImGui::SameLine();
+  if (ImGui::Button("Save CSV##counters")) {
+    metrics::SaveCsv("metrics_series.csv");
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Save JSON##counters")) {
+    metrics::SaveJson("metrics_series.json");
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Clear##counters")) {
+    metrics::ClearSamples();
+  }
+
+  ImGui::Separator();
+  ImGui::Text("Main Thread Tasks");
+  const auto& stats = app::main_thread::GetStats();
+  ImGui::SliderFloat("Budget##main_thread",
+                     &app::set::cpu.main_thread_budget_ms, 0.1f, 16.0f,
+                     "%.1f ms");
+  ImGui::Text("Executed: %.1f per frame, %.3f ms", stats.executed,
+              stats.busy_ms);
+  ImGui::Text("Carried: %.1f per frame", stats.carried);
+  ImGui::Text("Latency: avg %.3f ms, max %.3f ms", stats.latency_avg_ms,
+              stats.latency_max_ms);
+  ImGui::Text("Over budget: %d frames", stats.over_budget);
+
+  ImGui::Separator();
+  ImGui::Text("Workers");
+  ImGui::Text("CPU: %u logical, %u physical, %u L3", app::cpu.threads_total,
+              app::cpu.physical_cores, app::cpu.l3_groups);
+  static MiVector<app::task::WorkerStats> workers;
+  app::task::GetWorkerStats(workers);
+  if (ImGui::BeginTable("workers", 5, flags)) {
+    ImGui::TableSetupColumn("Worker");
+    ImGui::TableSetupColumn("CPU");
+    ImGui::TableSetupColumn("Tasks");
+    ImGui::TableSetupColumn("Steals");
+    ImGui::TableSetupColumn("Busy");
     ImGui::TableHeadersRow();
-    for (size_t row = 0; row < std::size(prof.time); row++) {
+    for (size_t row = 0; row < workers.size(); row++) {
+      const auto& worker = workers[row];
+      float total_ms = worker.busy_ms + worker.idle_ms;
       ImGui::TableNextRow();
       ImGui::TableNextColumn();
-      ImGui::Text("%s", NamedEnum<Metrics::Enum>::ToStr()[row]);
+      ImGui::Text("%zu", row);
+      ImGui::TableNextColumn();
+      ImGui::Text("%d", worker.processor);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(worker.tasks));
       ImGui::TableNextColumn();
-      ImGui::Text("%.3f ms", prof.time[row]);
+      ImGui::Text("%llu", static_cast<unsigned long long>(worker.steals));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f%%",
+                  total_ms > 0.0f ? 100.0f * worker.busy_ms / total_ms : 0.0f);
     }
     ImGui::EndTable();
   }
-  ImGui::Text("Total GPU: %.3f ms", prof.total_time);
+  if (ImGui::Button("Reset##workers")) {
+    app::task::ResetWorkerStats();
+  }
+
+  ImGui::Separator();
+  ImGui::Text("CPU Trace (chrome://tracing, ui.perfetto.dev)");
+  if (prof::IsCapturing()) {
+    if (ImGui::Button("Save##trace")) {
+      prof::SaveCapture("trace.json");
+    }
+  } else if (ImGui::Button("Capture##trace")) {
+    prof::StartCapture();
+  }
 }
 
 void WinSettings::ShowDebug() {
@@ -479,6 +606,54 @@ void WinSettings::ShowMemoryInfo() {
   ImGui::Text("SSBO: %llu MB", mem::MemoryUsed(mem::kBuffer, mem::kMB));
   ImGui::Text("VBO: %llu MB", mem::MemoryUsed(mem::kVertexBuffer, mem::kMB));
   ImGui::Text("TBO: %llu MB", mem::MemoryUsed(mem::kTexture, mem::kMB));
+
+  ImGui::Separator();
+  ImGui::Text("CPU");
+  const ImGuiTableFlags flags{ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg};
+  if (ImGui::BeginTable("cpu_memory", 4, flags)) {
+    ImGui::TableSetupColumn("Owner");
+    ImGui::TableSetupColumn("Current KB");
+    ImGui::TableSetupColumn("Peak KB");
+    ImGui::TableSetupColumn("Allocations");
+    ImGui::TableHeadersRow();
+    for (int row = 0; row < mem::Tag::kTotal; row++) {
+      auto tag = static_cast<mem::Tag::Enum>(row);
+      auto stats = mem::GetTagStats(tag, mem::kKB);
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", NamedEnum<mem::Tag::Enum>::ToStr()[row]);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", stats.current);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", stats.peak);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", stats.allocations);
+    }
+    ImGui::EndTable();
+  }
+  if (ImGui::Button("Reset Peaks##memory")) {
+    mem::ResetTagPeaks();
+  }
+
+  ImGui::Separator();
+  ImGui::Text("Heap allocations per frame");
+  bool tracking = prof::IsAllocTracking();
+  if (ImGui::Checkbox("Track (slow)##alloc", &tracking)) {
+    if (tracking) {
+      prof::StartAllocTracking();
+    } else {
+      prof::StopAllocTracking();
+    }
+  }
+  if (tracking) {
+    auto last = prof::GetLastAllocFrame();
+    auto max = prof::GetMaxAllocFrame();
+    ImGui::Text("Last: %llu (%llu KB)", last.count, last.bytes / mem::kKB);
+    ImGui::Text("Max: %llu (%llu KB)", max.count, max.bytes / mem::kKB);
+    if (ImGui::Button("Log Hotspots##alloc")) {
+      prof::LogAllocHotspots();
+    }
+  }
 }
 
 void WinSettings::MenuBar() {
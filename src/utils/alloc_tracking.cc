@@ -0,0 +1,402 @@
+#include "alloc_tracking.h"
+
+// os
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <dbghelp.h>
+#elif defined(__linux__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+// deps
+#include <fmt/core.h>
+#include <mimalloc.h>
+#include <spdlog/spdlog.h>
+// global
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+// local
+#include "mi_types.h"
+#include "utils/profiling.h"
+
+namespace prof {
+
+namespace {
+
+// the first frames are the tracker, the allocator and the containers
+constexpr int kStackDepth = 16;
+// open addressing, a call site after kMaxProbes is dropped
+constexpr size_t kMaxSites = 4096;
+constexpr size_t kMaxProbes = 32;
+// the last one is shared on overflow
+constexpr size_t kMaxZones = 128;
+constexpr const char *kNoZone = "(no zone)";
+
+using Stack = std::array<void *, kStackDepth>;
+
+struct Site {
+  // 0 is a free slot
+  uint64_t hash{0};
+  Stack frames{};
+  int depth{0};
+  const char *zone{nullptr};
+  uint64_t count{0};
+  uint64_t bytes{0};
+};
+
+struct ZoneAllocs {
+  const char *name{nullptr};
+  uint64_t count{0};
+  uint64_t bytes{0};
+};
+
+std::atomic<bool> gTracking = false;
+// the tables, a lock per allocation is fine for a debug mode
+std::mutex gMutex;
+std::array<Site, kMaxSites> gSites;
+std::array<ZoneAllocs, kMaxZones> gZones;
+size_t gZoneCount = 0;
+uint64_t gDropped = 0;
+
+// the current frame, all threads
+std::atomic<uint64_t> gFrameCount = 0;
+std::atomic<uint64_t> gFrameBytes = 0;
+// the closed frames, main thread
+AllocFrame gLastFrame;
+AllocFrame gMaxFrame;
+AllocFrame gTotal;
+uint64_t gFrames = 0;
+
+// the tracker and the report allocate too
+thread_local bool tInHook = false;
+
+int CaptureStack(Stack &frames) {
+#if defined(_WIN32)
+  return RtlCaptureStackBackTrace(0, kStackDepth, frames.data(), nullptr);
+#elif defined(__linux__)
+  return backtrace(frames.data(), kStackDepth);
+#else
+  return 0;
+#endif
+}
+
+// FNV-1a of the return addresses
+uint64_t Hash(const Stack &frames, int depth) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i = 0; i < depth; ++i) {
+    hash ^= reinterpret_cast<uintptr_t>(frames[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash ? hash : 1;
+}
+
+void AddZone(const char *name, size_t bytes) {
+  size_t i = 0;
+  while (i < gZoneCount && std::strcmp(gZones[i].name, name) != 0) ++i;
+  if (i == gZoneCount) {
+    if (gZoneCount == kMaxZones) {
+      i = kMaxZones - 1;
+    } else {
+      gZones[gZoneCount++].name = name;
+    }
+  }
+  ++gZones[i].count;
+  gZones[i].bytes += bytes;
+}
+
+void AddSite(const Stack &frames, int depth, const char *zone, size_t bytes) {
+  const uint64_t hash = Hash(frames, depth);
+  for (size_t probe = 0; probe < kMaxProbes; ++probe) {
+    auto &site = gSites[(hash + probe) % kMaxSites];
+    if (site.hash == 0) {
+      site.hash = hash;
+      site.frames = frames;
+      site.depth = depth;
+      site.zone = zone;
+    }
+    if (site.hash == hash) {
+      ++site.count;
+      site.bytes += bytes;
+      return;
+    }
+  }
+  ++gDropped;
+}
+
+void OnAllocation(size_t bytes) {
+  if (tInHook) return;
+  tInHook = true;
+  gFrameCount.fetch_add(1, std::memory_order_relaxed);
+  gFrameBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+  Stack frames;
+  const int depth = CaptureStack(frames);
+  const char *zone = GetCurrentZone();
+  if (zone == nullptr) zone = kNoZone;
+  {
+    std::scoped_lock lock(gMutex);
+    AddZone(zone, bytes);
+    AddSite(frames, depth, zone, bytes);
+  }
+  tInHook = false;
+}
+
+// main thread, DbgHelp is single threaded
+std::string Symbolize(void *address) {
+#if defined(_WIN32)
+  static const bool initialized = []() {
+    SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+    return SymInitialize(GetCurrentProcess(), nullptr, TRUE) != FALSE;
+  }();
+  if (!initialized) return fmt::format("{}", address);
+
+  HANDLE process = GetCurrentProcess();
+  const auto addr = reinterpret_cast<DWORD64>(address);
+  alignas(SYMBOL_INFO) char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+  auto *symbol = reinterpret_cast<SYMBOL_INFO *>(buffer);
+  symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+  symbol->MaxNameLen = MAX_SYM_NAME;
+  if (!SymFromAddr(process, addr, nullptr, symbol)) {
+    return fmt::format("{}", address);
+  }
+  IMAGEHLP_LINE64 line{};
+  line.SizeOfStruct = sizeof(line);
+  DWORD displacement = 0;
+  if (SymGetLineFromAddr64(process, addr, &displacement, &line)) {
+    return fmt::format("{} ({}:{})", symbol->Name, line.FileName,
+                       line.LineNumber);
+  }
+  return symbol->Name;
+#elif defined(__linux__)
+  Dl_info info;
+  if (dladdr(address, &info) && info.dli_sname) {
+    int status = 0;
+    char *demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : info.dli_sname;
+    std::free(demangled);
+    return name;
+  }
+  return fmt::format("{}", address);
+#else
+  return fmt::format("{}", address);
+#endif
+}
+
+// the allocator, the tracker and the library code aren't the call site
+bool IsInternal(const std::string &name) {
+  constexpr const char *kPrefixes[]{
+      "std::", "__gnu_cxx::", "operator new", "mem::", "prof::",
+      "mi_",   "fmt::",       "0x",
+  };
+  for (const char *prefix : kPrefixes) {
+    if (name.starts_with(prefix)) return true;
+  }
+  return false;
+}
+
+// the first frame of the engine
+std::string FindCallSite(const Site &site) {
+  std::string name;
+  for (int i = 0; i < site.depth; ++i) {
+    name = Symbolize(site.frames[i]);
+    if (!IsInternal(name)) return name;
+  }
+  return name.empty() ? std::string("(unknown)") : name;
+}
+
+struct CallSite {
+  std::string name;
+  const char *zone;
+  uint64_t count;
+  uint64_t bytes;
+};
+
+}  // namespace
+
+void StartAllocTracking() {
+  StopAllocTracking();
+  {
+    std::scoped_lock lock(gMutex);
+    gSites.fill({});
+    gZones.fill({});
+    gZoneCount = 0;
+    gDropped = 0;
+  }
+  gFrameCount = 0;
+  gFrameBytes = 0;
+  gLastFrame = {};
+  gMaxFrame = {};
+  gTotal = {};
+  gFrames = 0;
+  gTracking = true;
+  mem::gAllocHook = &OnAllocation;
+}
+
+void StopAllocTracking() {
+  mem::gAllocHook = nullptr;
+  gTracking = false;
+}
+
+bool IsAllocTracking() { return gTracking; }
+
+void MarkAllocFrame() {
+  if (!gTracking.load(std::memory_order_relaxed)) return;
+  const AllocFrame frame{
+      gFrameCount.exchange(0, std::memory_order_relaxed),
+      gFrameBytes.exchange(0, std::memory_order_relaxed),
+  };
+  gLastFrame = frame;
+  if (frame.count > gMaxFrame.count) gMaxFrame = frame;
+  gTotal.count += frame.count;
+  gTotal.bytes += frame.bytes;
+  ++gFrames;
+}
+
+AllocFrame GetLastAllocFrame() { return gLastFrame; }
+
+AllocFrame GetMaxAllocFrame() { return gMaxFrame; }
+
+void LogAllocHotspots(size_t top) {
+  // the copies are symbolized outside of the lock
+  tInHook = true;
+  MiVector<Site> sites;
+  MiVector<ZoneAllocs> zones;
+  uint64_t dropped = 0;
+  {
+    std::scoped_lock lock(gMutex);
+    for (const auto &site : gSites) {
+      if (site.hash) sites.push_back(site);
+    }
+    zones.assign(gZones.begin(), gZones.begin() + gZoneCount);
+    dropped = gDropped;
+  }
+
+  const double frames = static_cast<double>(std::max<uint64_t>(gFrames, 1));
+  spdlog::info(
+      "{}: {} frames, {:.1f} allocations ({:.1f} KB) per frame, "
+      "max {} ({} KB)",
+      __FUNCTION__, gFrames, static_cast<double>(gTotal.count) / frames,
+      static_cast<double>(gTotal.bytes) / 1024.0 / frames, gMaxFrame.count,
+      gMaxFrame.bytes / 1024);
+
+  std::sort(zones.begin(), zones.end(),
+            [](const auto &a, const auto &b) { return a.count > b.count; });
+  for (const auto &zone : zones) {
+    spdlog::info("  zone '{}': {} allocations, {} KB", zone.name, zone.count,
+                 zone.bytes / 1024);
+  }
+
+  // the stacks through the same function are one call site
+  MiVector<CallSite> call_sites;
+  MiUnMap<std::string, size_t> index;
+  for (const auto &site : sites) {
+    std::string name = FindCallSite(site);
+    auto [it, inserted] = index.try_emplace(name, call_sites.size());
+    if (inserted) {
+      call_sites.push_back({std::move(name), site.zone, 0, 0});
+    }
+    call_sites[it->second].count += site.count;
+    call_sites[it->second].bytes += site.bytes;
+  }
+  std::sort(call_sites.begin(), call_sites.end(),
+            [](const auto &a, const auto &b) { return a.count > b.count; });
+  const size_t count = std::min(top, call_sites.size());
+  for (size_t i = 0; i < count; ++i) {
+    const auto &site = call_sites[i];
+    spdlog::info("  {}: {} allocations, {} KB, zone '{}'", site.name,
+                 site.count, site.bytes / 1024, site.zone);
+  }
+  if (dropped) {
+    spdlog::warn("{}: {} allocations of untracked call sites", __FUNCTION__,
+                 dropped);
+  }
+  tInHook = false;
+}
+
+}  // namespace prof
+
+// replaces mimalloc-new-delete.h, the same overloads with the hook
+namespace {
+
+void Track(size_t bytes) {
+  if (auto hook = mem::gAllocHook.load(std::memory_order_relaxed)) {
+    hook(bytes);
+  }
+}
+
+}  // namespace
+
+void operator delete(void *p) noexcept { mi_free(p); }
+void operator delete[](void *p) noexcept { mi_free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { mi_free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  mi_free(p);
+}
+void operator delete(void *p, std::size_t n) noexcept { mi_free_size(p, n); }
+void operator delete[](void *p, std::size_t n) noexcept {
+  mi_free_size(p, n);
+}
+void operator delete(void *p, std::align_val_t al) noexcept {
+  mi_free_aligned(p, static_cast<size_t>(al));
+}
+void operator delete[](void *p, std::align_val_t al) noexcept {
+  mi_free_aligned(p, static_cast<size_t>(al));
+}
+void operator delete(void *p, std::size_t n, std::align_val_t al) noexcept {
+  mi_free_size_aligned(p, n, static_cast<size_t>(al));
+}
+void operator delete[](void *p, std::size_t n, std::align_val_t al) noexcept {
+  mi_free_size_aligned(p, n, static_cast<size_t>(al));
+}
+void operator delete(void *p, std::align_val_t al,
+                     const std::nothrow_t &) noexcept {
+  mi_free_aligned(p, static_cast<size_t>(al));
+}
+void operator delete[](void *p, std::align_val_t al,
+                       const std::nothrow_t &) noexcept {
+  mi_free_aligned(p, static_cast<size_t>(al));
+}
+
+void *operator new(std::size_t n) noexcept(false) {
+  Track(n);
+  return mi_new(n);
+}
+void *operator new[](std::size_t n) noexcept(false) {
+  Track(n);
+  return mi_new(n);
+}
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept {
+  Track(n);
+  return mi_new_nothrow(n);
+}
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept {
+  Track(n);
+  return mi_new_nothrow(n);
+}
+void *operator new(std::size_t n, std::align_val_t al) noexcept(false) {
+  Track(n);
+  return mi_new_aligned(n, static_cast<size_t>(al));
+}
+void *operator new[](std::size_t n, std::align_val_t al) noexcept(false) {
+  Track(n);
+  return mi_new_aligned(n, static_cast<size_t>(al));
+}
+void *operator new(std::size_t n, std::align_val_t al,
+                   const std::nothrow_t &) noexcept {
+  Track(n);
+  return mi_new_aligned_nothrow(n, static_cast<size_t>(al));
+}
+void *operator new[](std::size_t n, std::align_val_t al,
+                     const std::nothrow_t &) noexcept {
+  Track(n);
+  return mi_new_aligned_nothrow(n, static_cast<size_t>(al));
+}
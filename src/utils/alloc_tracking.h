@@ -0,0 +1,32 @@
+#pragma once
+
+// global
+#include <cstddef>
+#include <cstdint>
+
+// heap allocations per frame, per profiling zone (utils/profiling.h)
+// and per call site, to drive the steady state frames to zero allocations
+// counts operator new, MiVector/MiUnMap and the tagged memory (mem_info.h)
+// debug mode: a stack walk per allocation while tracking, a relaxed load
+// otherwise
+namespace prof {
+
+struct AllocFrame {
+  uint64_t count{0};
+  uint64_t bytes{0};
+};
+
+// clears the previous statistics
+void StartAllocTracking();
+void StopAllocTracking();
+bool IsAllocTracking();
+// once per frame on the main thread, closes the previous frame
+// (the allocations of the workers during the frame are included)
+void MarkAllocFrame();
+AllocFrame GetLastAllocFrame();
+AllocFrame GetMaxAllocFrame();
+// per frame averages, the zones and the top call sites by count
+// symbols need the debug info (PDB, -g -rdynamic)
+void LogAllocHotspots(size_t top = 10);
+
+}  // namespace prof
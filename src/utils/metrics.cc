@@ -0,0 +1,167 @@
+#include "metrics.h"
+
+// deps
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+// global
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace metrics {
+
+namespace {
+
+// the last one is shared on overflow
+constexpr size_t kMaxMetrics = 64;
+// ~2 MB, 68 minutes at 60 fps with the interval 60
+constexpr size_t kHistory = 4096;
+
+constexpr const char *kKindNames[]{"counter", "gauge"};
+
+// constant initialized, global metrics register before main()
+std::array<Slot, kMaxMetrics> gSlots;
+std::atomic<size_t> gCount = 0;
+std::mutex gMutex;
+
+struct Row {
+  uint64_t frame;
+  float time_s;
+  std::array<int64_t, kMaxMetrics> values;
+};
+
+// main thread
+MiVector<Row> gRows;
+uint64_t gHead = 0;
+uint64_t gFrame = 0;
+int gInterval = 1;
+const auto gStart = std::chrono::steady_clock::now();
+
+Slot *Register(const char *name, Kind::Enum kind) {
+  std::scoped_lock lock(gMutex);
+  const size_t count = gCount.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; ++i) {
+    if (std::strcmp(gSlots[i].name, name) == 0) return &gSlots[i];
+  }
+  if (count == kMaxMetrics) {
+    spdlog::warn("{}: Too many metrics, '{}' is shared", __FUNCTION__, name);
+    return &gSlots[kMaxMetrics - 1];
+  }
+  gSlots[count].name = name;
+  gSlots[count].kind = kind;
+  // the name is visible with the count
+  gCount.store(count + 1, std::memory_order_release);
+  return &gSlots[count];
+}
+
+// the oldest first
+template <typename F>
+void ForEachRow(F &&fn) {
+  const uint64_t first = gHead > kHistory ? gHead - kHistory : 0;
+  for (uint64_t i = first; i < gHead; ++i) {
+    fn(gRows[i % kHistory]);
+  }
+}
+
+}  // namespace
+
+Counter::Counter(const char *name) noexcept
+    : slot_(Register(name, Kind::kCounter)) {}
+
+Gauge::Gauge(const char *name) noexcept : slot_(Register(name, Kind::kGauge)) {}
+
+void Sample() {
+  if (gFrame++ % gInterval != 0) return;
+  if (gRows.empty()) gRows.resize(kHistory);
+
+  auto &row = gRows[gHead % kHistory];
+  row.frame = gFrame - 1;
+  row.time_s = std::chrono::duration<float>(std::chrono::steady_clock::now() -
+                                            gStart)
+                   .count();
+  const size_t count = gCount.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    row.values[i] = gSlots[i].value.load(std::memory_order_relaxed);
+  }
+  std::fill(row.values.begin() + count, row.values.end(), 0);
+  ++gHead;
+}
+
+void SetSampleInterval(int frames) { gInterval = std::max(frames, 1); }
+
+size_t GetSampleCount() { return std::min<uint64_t>(gHead, kHistory); }
+
+void ClearSamples() { gHead = 0; }
+
+void GetValues(MiVector<Value> &values) {
+  const size_t count = gCount.load(std::memory_order_acquire);
+  values.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = {gSlots[i].name, gSlots[i].kind,
+                 gSlots[i].value.load(std::memory_order_relaxed)};
+  }
+}
+
+bool SaveCsv(const std::string &filename) {
+  std::ofstream file(filename);
+  if (!file) {
+    spdlog::error("{}: Failed to open '{}'", __FUNCTION__, filename);
+    return false;
+  }
+
+  // the metrics registered after a sample are zero in it
+  const size_t count = gCount.load(std::memory_order_acquire);
+  file << "frame,time_s";
+  for (size_t i = 0; i < count; ++i) {
+    file << ',' << gSlots[i].name;
+  }
+  file << '\n';
+  ForEachRow([&file, count](const Row &row) {
+    file << fmt::format("{},{:.3f}", row.frame, row.time_s);
+    for (size_t i = 0; i < count; ++i) {
+      file << ',' << row.values[i];
+    }
+    file << '\n';
+  });
+
+  spdlog::info("{}: {} samples saved to '{}'", __FUNCTION__, GetSampleCount(),
+               filename);
+  return true;
+}
+
+bool SaveJson(const std::string &filename) {
+  std::ofstream file(filename);
+  if (!file) {
+    spdlog::error("{}: Failed to open '{}'", __FUNCTION__, filename);
+    return false;
+  }
+
+  const size_t count = gCount.load(std::memory_order_acquire);
+  file << "{\"metrics\":[";
+  for (size_t i = 0; i < count; ++i) {
+    file << fmt::format("{}\n{{\"name\":\"{}\",\"kind\":\"{}\"}}",
+                        i ? "," : "", gSlots[i].name,
+                        kKindNames[gSlots[i].kind]);
+  }
+  file << "\n],\n\"samples\":[";
+  bool first = true;
+  ForEachRow([&file, &first, count](const Row &row) {
+    file << fmt::format("{}\n{{\"frame\":{},\"time_s\":{:.3f},\"values\":[",
+                        first ? "" : ",", row.frame, row.time_s);
+    for (size_t i = 0; i < count; ++i) {
+      file << (i ? "," : "") << row.values[i];
+    }
+    file << "]}";
+    first = false;
+  });
+  file << "\n]}\n";
+
+  spdlog::info("{}: {} samples saved to '{}'", __FUNCTION__, GetSampleCount(),
+               filename);
+  return true;
+}
+
+}  // namespace metrics
@@ -0,0 +1,80 @@
+#pragma once
+
+// global
+#include <atomic>
+#include <cstdint>
+#include <string>
+// local
+#include "mi_types.h"
+
+// named counters and gauges of the whole engine, sampled once per frame
+// into a ring buffer and exported for the offline analysis (soak runs)
+// the updates are relaxed atomics, a slot per cache line
+namespace metrics {
+
+struct Kind {
+  enum Enum : uint8_t { kCounter, kGauge };
+};
+
+// shared by the metrics with the same name
+struct alignas(64) Slot {
+  const char *name{nullptr};
+  Kind::Enum kind{Kind::kCounter};
+  std::atomic<int64_t> value{0};
+};
+
+// monotonic (bytes uploaded, instances), the analysis takes the deltas
+// name is a string literal, the pointer is stored
+class Counter {
+ public:
+  explicit Counter(const char *name) noexcept;
+
+  void Add(int64_t value = 1) {
+    slot_->value.fetch_add(value, std::memory_order_relaxed);
+  }
+  // mirrors a monotonic total kept elsewhere (task system)
+  void Set(int64_t total) {
+    slot_->value.store(total, std::memory_order_relaxed);
+  }
+
+ private:
+  Slot *slot_;
+};
+
+// the current value (resident textures, visible instances)
+class Gauge {
+ public:
+  explicit Gauge(const char *name) noexcept;
+
+  void Set(int64_t value) {
+    slot_->value.store(value, std::memory_order_relaxed);
+  }
+  void Add(int64_t delta) {
+    slot_->value.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+ private:
+  Slot *slot_;
+};
+
+struct Value {
+  const char *name;
+  Kind::Enum kind;
+  int64_t value;
+};
+
+// main thread, once per frame, every interval-th frame is stored
+void Sample();
+void SetSampleInterval(int frames);
+size_t GetSampleCount();
+// clears the samples, the values stay
+void ClearSamples();
+// the current values in the order of the registration
+void GetValues(MiVector<Value> &values);
+
+// frame,time_s,<metric>... one row per sample, the oldest first
+bool SaveCsv(const std::string &filename);
+// {"metrics":[{"name","kind"}],"samples":[{"frame","time_s","values"}]}
+bool SaveJson(const std::string &filename);
+
+}  // namespace metrics
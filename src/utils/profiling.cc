@@ -0,0 +1,308 @@
+#include "profiling.h"
+
+// deps
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+// global
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+// local
+#include "mi_types.h"
+
+namespace prof {
+
+// relaxed: statistics only, the mutex orders everything else
+struct LockCounters {
+  const char *name{nullptr};
+  std::atomic<uint64_t> acquisitions{0};
+  std::atomic<uint64_t> contended{0};
+  std::atomic<int64_t> wait_ns{0};
+  std::atomic<int64_t> wait_max_ns{0};
+  std::atomic<int64_t> hold_ns{0};
+  std::atomic<int64_t> hold_max_ns{0};
+};
+
+namespace {
+
+// zones per thread (~768 KB), the ring keeps the latest
+constexpr uint64_t kRingSize = 32 * 1024;
+
+struct Event {
+  const char *name;
+  int64_t start_ns;
+  int64_t end_ns;
+};
+
+// the owner writes, SaveCapture() reads after the capture
+struct ThreadBuffer {
+  MiVector<Event> events;
+  std::atomic<uint64_t> head{0};
+  // pairs with gCapturing, StopCapture() waits for the current write
+  std::atomic<bool> writing{false};
+  std::string name;
+  size_t tid{0};
+};
+
+std::atomic<bool> gCapturing = false;
+std::atomic<int64_t> gCaptureStart = 0;
+// registration of the threads, export
+std::mutex gMutex;
+MiVector<std::unique_ptr<ThreadBuffer>> gBuffers;
+thread_local ThreadBuffer *tBuffer = nullptr;
+thread_local const char *tZone = nullptr;
+
+// names of the locks, the last one is shared on overflow
+constexpr size_t kMaxLocks = 32;
+// constant initialized, global mutexes register before main()
+std::array<LockCounters, kMaxLocks> gLocks;
+std::atomic<size_t> gLockCount = 0;
+std::mutex gLocksMutex;
+
+int64_t NowNs() {
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// once per thread, the buffer outlives the thread (detached loaders)
+ThreadBuffer &GetBuffer() {
+  if (tBuffer == nullptr) {
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->events.resize(kRingSize);
+    std::scoped_lock lock(gMutex);
+    buffer->tid = gBuffers.size();
+    tBuffer = gBuffers.emplace_back(std::move(buffer)).get();
+  }
+  return *tBuffer;
+}
+
+LockCounters *RegisterLock(const char *name) {
+  std::scoped_lock lock(gLocksMutex);
+  const size_t count = gLockCount.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; ++i) {
+    if (std::strcmp(gLocks[i].name, name) == 0) return &gLocks[i];
+  }
+  if (count == kMaxLocks) return &gLocks[kMaxLocks - 1];
+  gLocks[count].name = name;
+  gLockCount.store(count + 1, std::memory_order_release);
+  return &gLocks[count];
+}
+
+void UpdateMax(std::atomic<int64_t> &max, int64_t value) {
+  int64_t current = max.load(std::memory_order_relaxed);
+  while (value > current && !max.compare_exchange_weak(
+                                current, value, std::memory_order_relaxed)) {
+  }
+}
+
+float ToMs(const std::atomic<int64_t> &ns) {
+  return static_cast<float>(ns.load(std::memory_order_relaxed)) * 1e-6f;
+}
+
+// durations in microseconds
+void WriteEvents(std::ofstream &file, const ThreadBuffer &buffer,
+                 size_t &count) {
+  if (!buffer.name.empty()) {
+    file << fmt::format(
+        ",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+        "\"args\":{{\"name\":\"{}\"}}}}",
+        buffer.tid, buffer.name);
+  }
+
+  const int64_t start = gCaptureStart;
+  const uint64_t head = buffer.head.load(std::memory_order_acquire);
+  const uint64_t first = head > kRingSize ? head - kRingSize : 0;
+  for (uint64_t i = first; i < head; ++i) {
+    const auto &event = buffer.events[i % kRingSize];
+    // started before the capture
+    if (event.start_ns < start) continue;
+    file << fmt::format(
+        ",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},"
+        "\"ts\":{:.3f},\"dur\":{:.3f}}}",
+        event.name, buffer.tid, (event.start_ns - start) * 1e-3,
+        (event.end_ns - event.start_ns) * 1e-3);
+    ++count;
+  }
+}
+
+}  // namespace
+
+Percentiles RollingHistogram::GetPercentiles() const {
+  Percentiles result;
+  if (count_ == 0) return result;
+
+  std::array<float, kWindow> sorted;
+  std::copy_n(samples_.begin(), count_, sorted.begin());
+  std::sort(sorted.begin(), sorted.begin() + count_);
+  // nearest rank
+  auto rank = [this, &sorted](float p) {
+    auto index = static_cast<size_t>(p * static_cast<float>(count_ - 1));
+    return sorted[index];
+  };
+  result.p50 = rank(0.50f);
+  result.p95 = rank(0.95f);
+  result.p99 = rank(0.99f);
+  result.max = sorted[count_ - 1];
+  float sum = 0.0f;
+  for (size_t i = 0; i < count_; ++i) {
+    sum += sorted[i];
+  }
+  result.avg = sum / static_cast<float>(count_);
+  return result;
+}
+
+Zone::Zone(const char *name) noexcept
+    : name_(name),
+      parent_(tZone),
+      start_ns_(gCapturing.load(std::memory_order_relaxed) ? NowNs() : 0) {
+  tZone = name;
+}
+
+Zone::~Zone() noexcept {
+  tZone = parent_;
+  if (start_ns_ == 0) return;
+  auto &buffer = GetBuffer();
+  // seq_cst, either StopCapture() sees the write or the write sees the stop
+  buffer.writing.store(true);
+  if (gCapturing.load()) {
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % kRingSize] = {name_, start_ns_, NowNs()};
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+  buffer.writing.store(false, std::memory_order_release);
+}
+
+const char *GetCurrentZone() { return tZone; }
+
+void SetThreadName(const std::string &name) {
+  auto &buffer = GetBuffer();
+  std::scoped_lock lock(gMutex);
+  buffer.name = name;
+}
+
+void StartCapture() {
+  StopCapture();
+  std::scoped_lock lock(gMutex);
+  for (auto &buffer : gBuffers) {
+    buffer->head.store(0, std::memory_order_relaxed);
+  }
+  gCaptureStart = NowNs();
+  gCapturing = true;
+}
+
+void StopCapture() {
+  gCapturing = false;
+  std::scoped_lock lock(gMutex);
+  for (auto &buffer : gBuffers) {
+    while (buffer->writing.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool IsCapturing() { return gCapturing; }
+
+bool SaveCapture(const std::string &filename) {
+  StopCapture();
+  std::ofstream file(filename);
+  if (!file) {
+    spdlog::error("{}: Failed to open '{}'", __FUNCTION__, filename);
+    return false;
+  }
+
+  size_t count = 0;
+  // the first record makes the commas simple
+  file << "{\"traceEvents\":[\n"
+          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+          "\"args\":{\"name\":\"JokaeroEngine\"}}";
+  {
+    std::scoped_lock lock(gMutex);
+    for (const auto &buffer : gBuffers) {
+      WriteEvents(file, *buffer, count);
+    }
+  }
+  file << "\n]}\n";
+
+  spdlog::info("{}: {} zones saved to '{}'", __FUNCTION__, count, filename);
+  return true;
+}
+
+Mutex::Mutex(const char *name) noexcept : counters_(RegisterLock(name)) {}
+
+void Mutex::lock() {
+  if (mutex_.try_lock()) {
+    locked_ns_ = NowNs();
+  } else {
+    const int64_t start = NowNs();
+    mutex_.lock();
+    locked_ns_ = NowNs();
+    const int64_t wait = locked_ns_ - start;
+    counters_->contended.fetch_add(1, std::memory_order_relaxed);
+    counters_->wait_ns.fetch_add(wait, std::memory_order_relaxed);
+    UpdateMax(counters_->wait_max_ns, wait);
+  }
+  counters_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Mutex::try_lock() {
+  if (!mutex_.try_lock()) return false;
+  locked_ns_ = NowNs();
+  counters_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void Mutex::unlock() {
+  const int64_t hold = NowNs() - locked_ns_;
+  counters_->hold_ns.fetch_add(hold, std::memory_order_relaxed);
+  UpdateMax(counters_->hold_max_ns, hold);
+  mutex_.unlock();
+}
+
+void GetLockStats(MiVector<LockStats> &stats) {
+  const size_t count = gLockCount.load(std::memory_order_acquire);
+  stats.clear();
+  stats.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const auto &lock = gLocks[i];
+    stats.push_back({lock.name,
+                     lock.acquisitions.load(std::memory_order_relaxed),
+                     lock.contended.load(std::memory_order_relaxed),
+                     ToMs(lock.wait_ns), ToMs(lock.wait_max_ns),
+                     ToMs(lock.hold_ns), ToMs(lock.hold_max_ns)});
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const LockStats &a, const LockStats &b) {
+              return a.wait_ms > b.wait_ms;
+            });
+}
+
+void ResetLockStats() {
+  const size_t count = gLockCount.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    auto &lock = gLocks[i];
+    lock.acquisitions.store(0, std::memory_order_relaxed);
+    lock.contended.store(0, std::memory_order_relaxed);
+    lock.wait_ns.store(0, std::memory_order_relaxed);
+    lock.wait_max_ns.store(0, std::memory_order_relaxed);
+    lock.hold_ns.store(0, std::memory_order_relaxed);
+    lock.hold_max_ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LogLockStats() {
+  MiVector<LockStats> stats;
+  GetLockStats(stats);
+  for (const auto &lock : stats) {
+    spdlog::info(
+        "{}: {} acquired {}, contended {}, wait {:.3f} ms (max {:.3f}), "
+        "hold {:.3f} ms (max {:.3f})",
+        __FUNCTION__, lock.name, lock.acquisitions, lock.contended,
+        lock.wait_ms, lock.wait_max_ms, lock.hold_ms, lock.hold_max_ms);
+  }
+}
+
+}  // namespace prof
@@ -1,7 +1,14 @@
 #pragma once
 
 // global
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+// local
+#include "mi_types.h"
 
 namespace prof {
 
@@ -36,4 +43,104 @@ class Counter {
   steady_clock::time_point end_;
 };
 
+struct Percentiles {
+  float p50{0.0f};
+  float p95{0.0f};
+  float p99{0.0f};
+  float max{0.0f};
+  float avg{0.0f};
+};
+
+// the last kWindow samples (frames), the mean hides the stutters
+class RollingHistogram {
+ public:
+  static constexpr size_t kWindow = 512;
+
+  void Add(float value) {
+    samples_[next_] = value;
+    next_ = (next_ + 1) % kWindow;
+    count_ = std::min(count_ + 1, kWindow);
+  }
+  void Clear() { count_ = next_ = 0; }
+  size_t GetCount() const { return count_; }
+  // sorts a copy, call on demand (UI, dumps), not per sample
+  Percentiles GetPercentiles() const;
+
+ private:
+  std::array<float, kWindow> samples_{};
+  size_t count_{0};
+  size_t next_{0};
+};
+
+// scoped and nestable, recorded only during a capture
+// into the ring buffer of the calling thread (the oldest zones are lost)
+// name is a string literal, the pointer is stored
+// a coroutine zone must not cross co_await (the thread can change)
+class Zone {
+ public:
+  explicit Zone(const char *name) noexcept;
+  ~Zone() noexcept;
+  Zone(const Zone &) = delete;
+  Zone &operator=(const Zone &) = delete;
+
+ private:
+  const char *name_;
+  const char *parent_;
+  // 0 if not capturing
+  int64_t start_ns_;
+};
+
+// the innermost zone of the calling thread, nullptr outside of the zones
+// (also without a capture)
+const char *GetCurrentZone();
+
+// the thread row in the trace viewer
+void SetThreadName(const std::string &name);
+// clears the previous capture
+void StartCapture();
+void StopCapture();
+bool IsCapturing();
+// Chrome trace / Perfetto JSON (chrome://tracing, ui.perfetto.dev)
+// stops the capture
+bool SaveCapture(const std::string &filename);
+
+// per name, shared by the mutexes with the same name
+struct LockCounters;
+
+// std::mutex with contention statistics (Lockable, std::scoped_lock)
+// the fast path without a waiter costs two clock reads
+// name is a string literal, the pointer is stored
+class Mutex {
+ public:
+  explicit Mutex(const char *name) noexcept;
+  Mutex(const Mutex &) = delete;
+  Mutex &operator=(const Mutex &) = delete;
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+ private:
+  std::mutex mutex_;
+  LockCounters *counters_;
+  // written by the owner only
+  int64_t locked_ns_{0};
+};
+
+struct LockStats {
+  const char *name;
+  uint64_t acquisitions;
+  // the lock was taken, the thread had to wait
+  uint64_t contended;
+  float wait_ms;
+  float wait_max_ms;
+  float hold_ms;
+  float hold_max_ms;
+};
+
+// sorted by the total wait, the lock that limits the scaling goes first
+void GetLockStats(MiVector<LockStats> &stats);
+void ResetLockStats();
+void LogLockStats();
+
 }  // namespace prof